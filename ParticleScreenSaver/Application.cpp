@@ -1,5 +1,8 @@
 #include "Application.h"
 #include "fpsCounter.h"
+#include "ParticleKernel.h"
+#include "ParticleArena.h"
+#include "Verification.h"
 
 // OpenGL implementation of https://gpfault.net/posts/webgl2-particles.txt.html
 // original was made by nice byte
@@ -38,20 +41,49 @@ const char* updateVertexShaderSource = R"(
     uniform float u_MinSpeed;
     uniform float u_MaxSpeed;
 
+    /* Optional forces. Each is compiled in only when its FEATURE_* define is
+       set, so every enabled combination gets its own branch-free program.
+       RUNTIME_FEATURES instead compiles them all in and picks them per draw
+       from u_Features (ParticleFeature bits); it exists to benchmark against.
+       The FEATURE_*_BIT values are generated from the enum on the C++ side. */
+#ifdef RUNTIME_FEATURES
+    uniform uint u_Features;
+    bool featureEnabled(uint feature) { return (u_Features & feature) != 0u; }
+#define FEATURE_DRAG
+#define FEATURE_WIND
+#define FEATURE_BOUNDS
+#define FEATURE_ATTRACTOR
+#else
+    bool featureEnabled(uint feature) { return true; }
+#endif
+
+#ifdef FEATURE_DRAG
+    uniform float u_Drag;
+#endif
+#ifdef FEATURE_WIND
+    uniform vec2 u_Wind;
+#endif
+#ifdef FEATURE_ATTRACTOR
+    uniform vec2 u_Attractor;
+    uniform float u_AttractorStrength;
+#endif
+
 
     /* Inputs. These reflect the state of a single particle before the update. */
 
+    /* Locations are fixed so that every permutation shares the same VAOs. */
+
     /* Where the particle is. */
-    in vec2 i_Position;
+    layout(location = 0) in vec2 i_Position;
 
     /* Age of the particle in seconds. */
-    in float i_Age;
+    layout(location = 1) in float i_Age;
 
     /* How long this particle is supposed to live. */
-    in float i_Life;
+    layout(location = 2) in float i_Life;
 
     /* Which direction it is moving, and how fast. */ 
-    in vec2 i_Velocity;
+    layout(location = 3) in vec2 i_Velocity;
 
 
     /* Outputs. These mirror the inputs. These values will be captured
@@ -64,7 +96,7 @@ const char* updateVertexShaderSource = R"(
 
     void main() {
       if (i_Age >= i_Life) {
-        ivec2 noise_coord = ivec2(gl_VertexID % 512, gl_VertexID / 512);
+        ivec2 noise_coord = ivec2(gl_VertexID % 512, (gl_VertexID / 512) % 512);
         vec2 rand = texelFetch(u_RgNoise, noise_coord, 0).rg;
         float theta = u_MinTheta + rand.r*(u_MaxTheta - u_MinTheta);
 
@@ -85,10 +117,34 @@ const char* updateVertexShaderSource = R"(
 
       } else {
         /* Update parameters according to our simple rules.*/
-        v_Position = (i_Position/u_screenSize) + i_Velocity * u_TimeDelta;
+        /* Positions are kept in NDC; only the origin is given in pixels. */
+        v_Position = i_Position + i_Velocity * u_TimeDelta;
         v_Age = i_Age + u_TimeDelta;
         v_Life = i_Life;
         v_Velocity = i_Velocity + u_Gravity * u_TimeDelta;
+#ifdef FEATURE_WIND
+        if (featureEnabled(FEATURE_WIND_BIT)) {
+          v_Velocity += u_Wind * u_TimeDelta;
+        }
+#endif
+#ifdef FEATURE_ATTRACTOR
+        if (featureEnabled(FEATURE_ATTRACTOR_BIT)) {
+          v_Velocity += (u_Attractor - v_Position) * u_AttractorStrength * u_TimeDelta;
+        }
+#endif
+#ifdef FEATURE_DRAG
+        if (featureEnabled(FEATURE_DRAG_BIT)) {
+          v_Velocity *= 1.0 - u_Drag * u_TimeDelta;
+        }
+#endif
+#ifdef FEATURE_BOUNDS
+        if (featureEnabled(FEATURE_BOUNDS_BIT)) {
+          /* Reflect off the screen edges. */
+          vec2 outside = step(1.0, abs(v_Position));
+          v_Velocity = mix(v_Velocity, -v_Velocity, outside);
+          v_Position = clamp(v_Position, -1.0, 1.0);
+        }
+#endif
       }
     }
 )";
@@ -130,36 +186,217 @@ const char* renderFragmentShaderSource = R"(
     }
 )";
 
+// Trail mode decay pass: a full-screen triangle that copies the previous
+// accumulation texture with its colour scaled by u_Fade and alpha forced to 1.
+const char* trailVertexShaderSource = R"(
+    #version 330 core
+
+    void main() {
+      /* One triangle covering the screen, generated without a vertex buffer. */
+      vec2 position = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+      gl_Position = vec4(position * 2.0 - 1.0, 0.0, 1.0);
+    }
+)";
+
+const char* trailFragmentShaderSource = R"(
+    #version 330 core
+
+    /* Same size as the framebuffer, so texels map 1:1 to fragments. */
+    uniform sampler2D u_Accumulation;
+    uniform float u_Fade;
+
+    out vec4 o_FragColor;
+
+    void main() {
+      /* Only the colour fades; alpha stays 1 so the transparent window
+         framebuffer never shows through the trails. */
+      vec3 color = texelFetch(u_Accumulation, ivec2(gl_FragCoord.xy), 0).rgb;
+      o_FragColor = vec4(color * u_Fade, 1.0);
+    }
+)";
+
+// Live particle statistics, reduced in two passes from the same source: each
+// workgroup reduces 256 particles into a partial, then FINAL_PASS reduces
+// the partials with a single workgroup. Stats mirrors ParticleStats.
+const char* statsComputeShaderSource = R"(
+    #version 430 core
+
+    layout(local_size_x = 256) in;
+
+    /* Transform feedback layout of a particle, see Particle.h */
+    struct Particle {
+      vec2 position;
+      float age;
+      float life;
+      vec2 velocity;
+    };
+
+    struct Stats {
+      uint aliveCount;
+      float minX, minY, maxX, maxY;
+      float speedSum;
+      float maxSpeed;
+      uint padding;
+      uint ageHistogram[16];
+    };
+
+#ifdef FINAL_PASS
+    layout(std430, binding = 0) readonly buffer Partials { Stats partials[]; };
+    layout(std430, binding = 1) writeonly buffer Result { Stats result; };
+#else
+    layout(std430, binding = 0) readonly buffer Particles { Particle particles[]; };
+    layout(std430, binding = 1) writeonly buffer Partials { Stats partials[]; };
+#endif
+
+    /* Number of particles, or of partials in the final pass. */
+    uniform uint u_Count;
+
+    shared uint s_Alive[256];
+    shared vec4 s_Bounds[256];
+    shared vec2 s_Speed[256]; /* sum, max */
+    shared uint s_Histogram[16];
+
+    void main() {
+      uint id = gl_LocalInvocationID.x;
+
+      if (id < 16u) {
+        s_Histogram[id] = 0u;
+      }
+      memoryBarrierShared();
+      barrier();
+
+      uint alive = 0u;
+      /* Exactly FLT_MAX, so an empty reduction matches emptyParticleStats() */
+      float floatMax = uintBitsToFloat(0x7f7fffffu);
+      vec4 bounds = vec4(floatMax, floatMax, -floatMax, -floatMax);
+      vec2 speed = vec2(0.0);
+
+#ifdef FINAL_PASS
+      for (uint i = id; i < u_Count; i += 256u) {
+        Stats partial = partials[i];
+        alive += partial.aliveCount;
+        bounds = vec4(min(bounds.xy, vec2(partial.minX, partial.minY)), max(bounds.zw, vec2(partial.maxX, partial.maxY)));
+        speed = vec2(speed.x + partial.speedSum, max(speed.y, partial.maxSpeed));
+        for (int bin = 0; bin < 16; ++bin) {
+          atomicAdd(s_Histogram[bin], partial.ageHistogram[bin]);
+        }
+      }
+#else
+      uint index = gl_GlobalInvocationID.x;
+      if (index < u_Count) {
+        Particle p = particles[index];
+        if (p.age < p.life) {
+          float s = length(p.velocity);
+          alive = 1u;
+          bounds = vec4(p.position, p.position);
+          speed = vec2(s, s);
+          atomicAdd(s_Histogram[min(uint(p.age / p.life * 16.0), 15u)], 1u);
+        }
+      }
+#endif
+
+      s_Alive[id] = alive;
+      s_Bounds[id] = bounds;
+      s_Speed[id] = speed;
+      memoryBarrierShared();
+      barrier();
+
+      /* Tree reduction in shared memory. */
+      for (uint stride = 128u; stride > 0u; stride >>= 1) {
+        if (id < stride) {
+          s_Alive[id] += s_Alive[id + stride];
+          s_Bounds[id] = vec4(min(s_Bounds[id].xy, s_Bounds[id + stride].xy), max(s_Bounds[id].zw, s_Bounds[id + stride].zw));
+          s_Speed[id] = vec2(s_Speed[id].x + s_Speed[id + stride].x, max(s_Speed[id].y, s_Speed[id + stride].y));
+        }
+        memoryBarrierShared();
+        barrier();
+      }
+
+      if (id == 0u) {
+        Stats stats;
+        stats.aliveCount = s_Alive[0];
+        stats.minX = s_Bounds[0].x;
+        stats.minY = s_Bounds[0].y;
+        stats.maxX = s_Bounds[0].z;
+        stats.maxY = s_Bounds[0].w;
+        stats.speedSum = s_Speed[0].x;
+        stats.maxSpeed = s_Speed[0].y;
+        stats.padding = 0u;
+        for (int bin = 0; bin < 16; ++bin) {
+          stats.ageHistogram[bin] = s_Histogram[bin];
+        }
+
+#ifdef FINAL_PASS
+        result = stats;
+#else
+        partials[gl_WorkGroupID.x] = stats;
+#endif
+      }
+    }
+)";
+
+// Uniform in [0, 1) from the top 24 bits. Written out by hand because the
+// standard distributions may differ between standard libraries.
+static float randomUnit(mt19937& random) {
+    return (random() >> 8) * (1.0f / 16777216.0f);
+}
+
 // Function to generate random RGB data
-vector<uint8_t> randomRGData(int size_x, int size_y) {
+vector<uint8_t> randomRGData(mt19937& random, int size_x, int size_y) {
     vector<uint8_t> data;
     for (int i = 0; i < size_x * size_y; ++i) {
-        data.push_back(static_cast<uint8_t>(rand() % 256));
-        data.push_back(static_cast<uint8_t>(rand() % 256));
+        data.push_back(static_cast<uint8_t>(random() >> 24));
+        data.push_back(static_cast<uint8_t>(random() >> 24));
     }
     return data;
 }
 
 // Function to initialize particle data
-vector<Particle> initialParticleData(int num_parts, float min_age, float max_age, IntVector2 windowDimensions) {
-    vector<Particle> data;
+void initialParticleData(mt19937& random, Particle* data, int num_parts, float min_age, float max_age, IntVector2 windowDimensions) {
     for (int i = 0; i < num_parts; ++i) {
-        float life = min_age + static_cast<float>(rand()) / RAND_MAX * (max_age - min_age);
-        float rX = (-windowDimensions.x) + static_cast<float>(rand()) / RAND_MAX * (windowDimensions.x - (-windowDimensions.x));
-        float rY = (-windowDimensions.y) + static_cast<float>(rand()) / RAND_MAX * (windowDimensions.y - (-windowDimensions.y));
+        float life = min_age + randomUnit(random) * (max_age - min_age);
+        float rX = (-windowDimensions.x) + randomUnit(random) * (windowDimensions.x - (-windowDimensions.x));
+        float rY = (-windowDimensions.y) + randomUnit(random) * (windowDimensions.y - (-windowDimensions.y));
 
         Particle particle = {
             rX, // px
             rY, // py
+            life + 1.0f, // age
+            life, // life
             0.0, // vx
-            0.0, // vy
-            life + 1.0, // age
-            life // life
+            0.0 // vy
         };
 
-        data.push_back(particle);
+        data[i] = particle;
     }
-    return data;
+}
+
+// Inserts `defines` right after the #version line
+string insertShaderDefines(const char* source, const string& defines) {
+    string permutation = source;
+    size_t versionEnd = permutation.find('\n', permutation.find("#version"));
+    permutation.insert(versionEnd + 1, defines);
+    return permutation;
+}
+
+// ParticleFeature bit values for featureEnabled() in the update shader, so
+// the shader never hard-codes them
+string featureBitDefines() {
+    return "#define FEATURE_DRAG_BIT " + to_string(FeatureDrag) + "u\n"
+        + "#define FEATURE_WIND_BIT " + to_string(FeatureWind) + "u\n"
+        + "#define FEATURE_BOUNDS_BIT " + to_string(FeatureBounds) + "u\n"
+        + "#define FEATURE_ATTRACTOR_BIT " + to_string(FeatureAttractor) + "u\n";
+}
+
+// Update shader source with the FEATURE_* defines for `features`
+string buildUpdateShaderPermutation(const char* source, unsigned features) {
+    string defines = featureBitDefines();
+    if (features & FeatureDrag) defines += "#define FEATURE_DRAG\n";
+    if (features & FeatureWind) defines += "#define FEATURE_WIND\n";
+    if (features & FeatureBounds) defines += "#define FEATURE_BOUNDS\n";
+    if (features & FeatureAttractor) defines += "#define FEATURE_ATTRACTOR\n";
+
+    return insertShaderDefines(source, defines);
 }
 
 size_t getArraySize(const char* array[]) {
@@ -306,11 +543,15 @@ void Application::createWindow()
 
     // Set Hints
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 5); // DSA; also what Mesa's llvmpipe offers
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
     glfwWindowHint(GLFW_RESIZABLE, GLFW_FALSE);
-    glfwWindowHint(GLFW_SAMPLES, 4);  // Set the number of samples for anti-aliasing
+    // Set the number of samples for anti-aliasing. Trails draw particles into
+    // a single-sample texture and blit it to the window, which needs the
+    // window single-sampled too.
+    glfwWindowHint(GLFW_SAMPLES, trails ? 0 : 4);
     glfwWindowHint(GLFW_TRANSPARENT_FRAMEBUFFER, GL_TRUE);  // Enable transparent
+    glfwWindowHint(GLFW_VISIBLE, _headless ? GLFW_FALSE : GLFW_TRUE);
 
     // Create Window
     _window = glfwCreateWindow(windowDimensions.x, windowDimensions.y, title, NULL, NULL);
@@ -365,17 +606,19 @@ void setupBufferVAO(GLuint vao, GLuint* buffer, AttributeLocation* attributes) {
 void Application::setupBuffers() {
     GLsizei stride = sizeof(Particle);
 
+    GLuint updateProgram = _getUpdateProgram(features);
+
     AttributeLocation update_attrib_locations[] = {
-        { glGetAttribLocation(_updateProgram, "i_Position"), 2, stride, GL_FLOAT},
-        { glGetAttribLocation(_updateProgram, "i_Age"), 1, stride, GL_FLOAT},
-        { glGetAttribLocation(_updateProgram, "i_Life"), 1, stride, GL_FLOAT},
-        { glGetAttribLocation(_updateProgram, "i_Velocity"), 2, stride, GL_FLOAT},
-        { -1, 0, 0, 0}
+        { static_cast<GLuint>(glGetAttribLocation(updateProgram, "i_Position")), 2, stride, GL_FLOAT},
+        { static_cast<GLuint>(glGetAttribLocation(updateProgram, "i_Age")), 1, stride, GL_FLOAT},
+        { static_cast<GLuint>(glGetAttribLocation(updateProgram, "i_Life")), 1, stride, GL_FLOAT},
+        { static_cast<GLuint>(glGetAttribLocation(updateProgram, "i_Velocity")), 2, stride, GL_FLOAT},
+        { static_cast<GLuint>(-1), 0, 0, 0 }
     };
 
     AttributeLocation render_attrib_locations[] = {
-        { glGetAttribLocation(_renderProgram, "i_Position"), 2, stride, GL_FLOAT},
-        { -1, 0, 0, 0}
+        { static_cast<GLuint>(glGetAttribLocation(_renderProgram, "i_Position")), 2, stride, GL_FLOAT},
+        { static_cast<GLuint>(-1), 0, 0, 0 }
     };
 
     setupBufferVAO(_particleVAO[0], &_particleBuffers[0], update_attrib_locations);
@@ -393,17 +636,40 @@ void Application::genBuffers() {
     glCreateBuffers(1, &_particleBuffers[1]);
 }
 
-void Application::compileShaders() {
+GLuint Application::_getUpdateProgram(unsigned featureSet) {
+    bool runtime = featureSet == RuntimeFeatureProgram;
+    if (!runtime) {
+        featureSet &= FeatureAll;
+    }
+
+    auto cached = _updatePrograms.find(featureSet);
+    if (cached != _updatePrograms.end()) {
+        return cached->second;
+    }
+
     const char* transformVaryings[] = {"v_Position", "v_Age", "v_Life", "v_Velocity", nullptr};
 
-    _updateProgram = createProgram(
+    string name = runtime ? string("particle-update-vert:runtime") : "particle-update-vert:" + to_string(featureSet);
+    string source = runtime
+        ? insertShaderDefines(updateVertexShaderSource, featureBitDefines() + "#define RUNTIME_FEATURES\n")
+        : buildUpdateShaderPermutation(updateVertexShaderSource, featureSet);
+
+    GLuint program = createProgram(
         {
-            {"particle-update-vert", ShaderType::Vertex, updateVertexShaderSource},
+            {name.c_str(), ShaderType::Vertex, source.c_str()},
             {"passthru-frag-shader", ShaderType::Fragment, updateFragmentShaderSource}
         },
         transformVaryings
     );
 
+    _updatePrograms[featureSet] = program;
+    return program;
+}
+
+void Application::compileShaders() {
+    // Update permutations are compiled on first use; warm the current one.
+    _getUpdateProgram(features);
+
     _renderProgram = createProgram(
         {
             {"particle-render-vert", ShaderType::Vertex, renderVertexShaderSource},
@@ -413,27 +679,129 @@ void Application::compileShaders() {
     );
 }
 
-void Application::_update(double tt, double dt)
+void Application::_setupStats() {
+    string finalSource = insertShaderDefines(statsComputeShaderSource, "#define FINAL_PASS\n");
+
+    _statsPartialProgram = createProgram({ {"particle-stats-comp", ShaderType::Compute, statsComputeShaderSource} }, nullptr);
+    _statsFinalProgram = createProgram({ {"particle-stats-final-comp", ShaderType::Compute, finalSource.c_str()} }, nullptr);
+
+    GLuint groups = (numParticles + 255) / 256;
+
+    glCreateBuffers(1, &_statsPartialBuffer);
+    glNamedBufferData(_statsPartialBuffer, groups * sizeof(ParticleStats), nullptr, GL_DYNAMIC_COPY);
+
+    glCreateBuffers(StatsRingSize, _statsBuffers);
+    for (int i = 0; i < StatsRingSize; ++i) {
+        glNamedBufferData(_statsBuffers[i], sizeof(ParticleStats), nullptr, GL_STREAM_READ);
+        _statsFences[i] = nullptr;
+    }
+
+    particleStats = emptyParticleStats();
+
+    if (statsExportPath != nullptr) {
+        _statsExport.open(statsExportPath);
+        if (_statsExport.is_open()) {
+            _statsExport << particleStatsCsvHeader() << endl;
+        }
+        else {
+            cerr << "Failed to open stats export file " << statsExportPath << "!" << endl;
+        }
+    }
+}
+
+void Application::_requestStats(GLuint particleBuffer, double tt) {
+    // Every slot is still in flight, skip rather than wait on the GPU
+    if (_statsFences[_statsNext] != nullptr) {
+        return;
+    }
+
+    GLuint groups = (numParticles + 255) / 256;
+
+    glUseProgram(_statsPartialProgram);
+    glUniform1ui(glGetUniformLocation(_statsPartialProgram, "u_Count"), numParticles);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, particleBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, _statsPartialBuffer);
+    glDispatchCompute(groups, 1, 1);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+    glUseProgram(_statsFinalProgram);
+    glUniform1ui(glGetUniformLocation(_statsFinalProgram, "u_Count"), groups);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, _statsPartialBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, _statsBuffers[_statsNext]);
+    glDispatchCompute(1, 1, 1);
+    glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, 0);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, 0);
+
+    _statsFences[_statsNext] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    _statsTimes[_statsNext] = tt;
+    _statsNext = (_statsNext + 1) % StatsRingSize;
+}
+
+void Application::_collectStats() {
+    // Read back, oldest first, every result whose fence has already signaled
+    while (_statsFences[_statsOldest] != nullptr) {
+        GLenum status = glClientWaitSync(_statsFences[_statsOldest], 0, 0);
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+            break;
+        }
+
+        glGetNamedBufferSubData(_statsBuffers[_statsOldest], 0, sizeof(ParticleStats), &particleStats);
+        glDeleteSync(_statsFences[_statsOldest]);
+        _statsFences[_statsOldest] = nullptr;
+
+        if (_statsExport.is_open()) {
+            _statsExport << particleStatsCsvRow(_statsTimes[_statsOldest], particleStats) << endl;
+        }
+
+        _statsOldest = (_statsOldest + 1) % StatsRingSize;
+    }
+}
+
+ParticleUpdateParams Application::_updateParams(float dt) {
+    ParticleUpdateParams params = {
+        dt,
+        { gravity[0], gravity[1] },
+        { origin[0], origin[1] },
+        { static_cast<float>(windowDimensions.x), static_cast<float>(windowDimensions.y) },
+        { theta[0], theta[1] },
+        { speed[0], speed[1] },
+        drag,
+        { wind[0], wind[1] },
+        { attractor[0], attractor[1] },
+        attractorStrength
+    };
+    return params;
+}
+
+void Application::_runUpdatePass(GLuint updateProgram, unsigned featureSet, double tt, double dt)
 {
-    // Main (RENDER)
-    glUseProgram(_updateProgram);
-
-    glUniform1f(glGetUniformLocation(_updateProgram, "u_TimeDelta"), dt);
-    glUniform1f(glGetUniformLocation(_updateProgram, "u_TotalTime"), tt);
-    glUniform2f(glGetUniformLocation(_updateProgram, "u_Gravity"), gravity[0], gravity[1]);
-    glUniform2f(glGetUniformLocation(_updateProgram, "u_Origin"), origin[0], origin[1]);
-    glUniform2f(glGetUniformLocation(_updateProgram, "u_screenSize"), windowDimensions.x, windowDimensions.y);
-    glUniform1f(glGetUniformLocation(_updateProgram, "u_MinTheta"), theta[0]);
-    glUniform1f(glGetUniformLocation(_updateProgram, "u_MaxTheta"), theta[1]);
-    glUniform1f(glGetUniformLocation(_updateProgram, "u_MinSpeed"), speed[0]);
-    glUniform1f(glGetUniformLocation(_updateProgram, "u_MaxSpeed"), speed[1]);
+    glUseProgram(updateProgram);
+
+    glUniform1f(glGetUniformLocation(updateProgram, "u_TimeDelta"), dt);
+    glUniform1f(glGetUniformLocation(updateProgram, "u_TotalTime"), tt);
+    glUniform2f(glGetUniformLocation(updateProgram, "u_Gravity"), gravity[0], gravity[1]);
+    glUniform2f(glGetUniformLocation(updateProgram, "u_Origin"), origin[0], origin[1]);
+    glUniform2f(glGetUniformLocation(updateProgram, "u_screenSize"), windowDimensions.x, windowDimensions.y);
+    glUniform1f(glGetUniformLocation(updateProgram, "u_MinTheta"), theta[0]);
+    glUniform1f(glGetUniformLocation(updateProgram, "u_MaxTheta"), theta[1]);
+    glUniform1f(glGetUniformLocation(updateProgram, "u_MinSpeed"), speed[0]);
+    glUniform1f(glGetUniformLocation(updateProgram, "u_MaxSpeed"), speed[1]);
+
+    // Locations are -1 (and the calls ignored) when the feature is compiled out
+    glUniform1f(glGetUniformLocation(updateProgram, "u_Drag"), drag);
+    glUniform2f(glGetUniformLocation(updateProgram, "u_Wind"), wind[0], wind[1]);
+    glUniform2f(glGetUniformLocation(updateProgram, "u_Attractor"), attractor[0], attractor[1]);
+    glUniform1f(glGetUniformLocation(updateProgram, "u_AttractorStrength"), attractorStrength);
+    glUniform1ui(glGetUniformLocation(updateProgram, "u_Features"), featureSet);
 
     glActiveTexture(GL_TEXTURE0);
     glBindTexture(GL_TEXTURE_2D, _noiseTexture);
-    glUniform1i(glGetUniformLocation(_updateProgram, "u_RgNoise"), 0);
+    glUniform1i(glGetUniformLocation(updateProgram, "u_RgNoise"), 0);
 
-    // bind read
-    glBindVertexArray(_particleVAO[_read]); // wrong?
+    // bind read (update VAOs are 0/1, one per buffer)
+    glBindVertexArray(_particleVAO[_read]);
 
     // bind write
     glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, _particleBuffers[_write]);
@@ -446,23 +814,110 @@ void Application::_update(double tt, double dt)
     glDisable(GL_RASTERIZER_DISCARD);
     glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0);
 
-    glBindVertexArray(_particleVAO[_read + 2]);
-    glUseProgram(_renderProgram);
-    glDrawArrays(GL_POINTS, 0, numParticles);
-
     // Swap Read/Write Buffers
     int temp = _read;
     _read = _write;
     _write = temp;
 
     //cout << "read val: " << _read << endl;
+}
+
+void Application::_simulate(double tt, double dt)
+{
+    _runUpdatePass(_getUpdateProgram(features), features, tt, dt);
+
+    // Reduce the freshly written state; results are picked up frames later
+    _collectStats();
+    if (tt - _statsLastRequest >= statsInterval) {
+        _requestStats(_particleBuffers[_read], tt);
+        _statsLastRequest = tt;
+    }
+}
+
+void Application::_render()
+{
+    // Render VAOs are 2/3; _read holds the state just simulated
+    glBindVertexArray(_particleVAO[_read + 2]);
+    glUseProgram(_renderProgram);
+    glDrawArrays(GL_POINTS, 0, numParticles);
+}
+
+void Application::_setupTrails() {
+    _trailProgram = createProgram(
+        {
+            {"trail-vert", ShaderType::Vertex, trailVertexShaderSource},
+            {"trail-frag", ShaderType::Fragment, trailFragmentShaderSource}
+        },
+        nullptr
+    );
 
+    // Core profile needs a VAO bound even though the triangle has no attributes
+    glCreateVertexArrays(1, &_trailVAO);
+
+    // Half floats so faint trails keep fading instead of sticking at 8-bit rounding
+    glCreateTextures(GL_TEXTURE_2D, 2, _trailTextures);
+    glCreateFramebuffers(2, _trailFramebuffers);
+
+    for (int i = 0; i < 2; ++i) {
+        glTextureStorage2D(_trailTextures[i], 1, GL_RGBA16F, windowDimensions.x, windowDimensions.y);
+        glNamedFramebufferTexture(_trailFramebuffers[i], GL_COLOR_ATTACHMENT0, _trailTextures[i], 0);
+
+        const float clear[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+        glClearNamedFramebufferfv(_trailFramebuffers[i], GL_COLOR, 0, clear);
+    }
+}
+
+void Application::_drawTrailPass(GLuint source, float fade) {
+    glUseProgram(_trailProgram);
+    glUniform1f(glGetUniformLocation(_trailProgram, "u_Fade"), fade);
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, source);
+    glUniform1i(glGetUniformLocation(_trailProgram, "u_Accumulation"), 0);
+
+    glBindVertexArray(_trailVAO);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+}
+
+void Application::_renderTrails(double dt)
+{
+    int write = 1 - _trailRead;
+
+    // Decay last frame's accumulation into the other texture, then draw only
+    // the current particles on top; cost doesn't depend on the trail length.
+    glBindFramebuffer(GL_FRAMEBUFFER, _trailFramebuffers[write]);
+    glDisable(GL_BLEND);
+    _drawTrailPass(_trailTextures[_trailRead], static_cast<float>(exp(-trailDecay * dt)));
+    glEnable(GL_BLEND);
+    _render();
+
+    // Present. Trail mode creates a single-sample window, so this is a blit
+    // rather than another full-screen pass.
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glBlitNamedFramebuffer(_trailFramebuffers[write], 0,
+        0, 0, windowDimensions.x, windowDimensions.y,
+        0, 0, windowDimensions.x, windowDimensions.y,
+        GL_COLOR_BUFFER_BIT, GL_NEAREST);
+
+    _trailRead = write;
+}
+
+void Application::_update(double tt, double dt)
+{
+    _simulate(tt, dt);
+
+    if (trails) {
+        _renderTrails(dt);
+    }
+    else {
+        _render();
+    }
 
     // Set FPS Counter
     double DisplayDelta = _applicationCurrentTime - _applicationLastDisplayUpdate;
 
     if (DisplayDelta >= 1.0f) {
-        string newWindowTitle = string(title) + " [FPS: " + to_string(static_cast<int>(_applicationFrameCount + 0.5f)) + "]" + "[ UP-TIME: " + to_string(static_cast<int>(tt)) + "]" + "[ PARTICLE-COUNT: " + to_string(numParticles)+"]";
+        string newWindowTitle = string(title) + " [FPS: " + to_string(static_cast<int>(_applicationFrameCount + 0.5f)) + "]" + "[ UP-TIME: " + to_string(static_cast<int>(tt)) + "]" + "[ PARTICLE-COUNT: " + to_string(numParticles)+"]" + "[ ALIVE: " + to_string(particleStats.aliveCount) + "]" + "[ SPEED: " + to_string(particleStats.meanSpeed()) + "/" + to_string(particleStats.maxSpeed) + "]" + "[ CPU/FRAME: " + to_string(_pacer.cpuMsPerFrame) + "ms]" + "[ WAKEUPS/S: " + to_string(static_cast<int>(_pacer.wakeupsPerSecond + 0.5)) + "]";
         _applicationFrameCount = 0;
 
         glfwSetWindowTitle(_window, newWindowTitle.c_str());
@@ -474,9 +929,7 @@ void Application::_update(double tt, double dt)
     }
 }
 
-void Application::run() {
-    if (!_window) return;
-
+bool Application::_setup() {
     // Compile Shaders
     cout << "Compiling Shaders!" << endl;
     compileShaders();
@@ -485,14 +938,24 @@ void Application::run() {
     // Populate
     genBuffers();    
     
-    vector<Particle> particles = initialParticleData(numParticles, minAge, maxAge, windowDimensions);
+    size_t dataSize = numParticles * sizeof(Particle);
+
+    ParticleArena arena(dataSize);
+    Particle* particles = arena.allocateArray<Particle>(numParticles);
+    if (particles == nullptr) {
+        cerr << "Failed to allocate particle storage!" << endl;
+        return false;
+    }
+
+    cout << "Particle storage: " << arena.capacity() / (1024 * 1024) << " MiB, " << arena.pageKind << " pages, "
+        << arena.pageFaults << " page faults, " << arena.allocationMs << " ms" << endl;
 
-    size_t dataSize = particles.size() * sizeof(Particle);
+    initialParticleData(_random, particles, numParticles, minAge, maxAge, windowDimensions);
 
     glBindBuffer(GL_ARRAY_BUFFER, _particleBuffers[0]);
-    glBufferData(GL_ARRAY_BUFFER, dataSize, particles.data(), GL_STREAM_DRAW);
+    glBufferData(GL_ARRAY_BUFFER, dataSize, particles, GL_STREAM_DRAW);
     glBindBuffer(GL_ARRAY_BUFFER, _particleBuffers[1]);
-    glBufferData(GL_ARRAY_BUFFER, dataSize, particles.data(), GL_STREAM_DRAW);
+    glBufferData(GL_ARRAY_BUFFER, dataSize, particles, GL_STREAM_DRAW);
 
     glBindBuffer(GL_ARRAY_BUFFER, 0);
 
@@ -501,10 +964,13 @@ void Application::run() {
     setupBuffers();
     cout << "Created Buffers!" << endl;
 
-    // Create random noise texture
+    _setupStats();
+
+    // Create random noise texture, keeping a copy for the CPU kernel
+    _noiseData = randomRGData(_random, NoiseTextureSize, NoiseTextureSize);
     glCreateTextures(GL_TEXTURE_2D, 1, &_noiseTexture);
     glBindTexture(GL_TEXTURE_2D, _noiseTexture);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, 512, 512, 0, GL_RG, GL_UNSIGNED_BYTE, randomRGData(512, 512).data());
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, NoiseTextureSize, NoiseTextureSize, 0, GL_RG, GL_UNSIGNED_BYTE, _noiseData.data());
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_MIRRORED_REPEAT);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_MIRRORED_REPEAT);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
@@ -514,37 +980,355 @@ void Application::run() {
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
     glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+
+    if (trails) {
+        _setupTrails();
+    }
+
+    return true;
+}
+
+void Application::run() {
+    if (!_window) return;
+
+    if (!_setup()) {
+        glfwDestroyWindow(_window);
+        glfwTerminate();
+        return;
+    }
+
+    _pacer = FramePacer(targetFrameRate, backgroundFrameRate > 0.0 ? backgroundFrameRate : targetFrameRate);
+    _pacer.start();
+    _applicationLastUpdate = glfwGetTime();
+
     while (!glfwWindowShouldClose(_window)) {
         _applicationCurrentTime = glfwGetTime();
 
-        //glViewport(0, 0, windowDimensions.x, windowDimensions.y);
-        glClear(GL_COLOR_BUFFER_BIT);
+        // Nothing is visible while iconified, so don't simulate or draw at all
+        bool iconified = glfwGetWindowAttrib(_window, GLFW_ICONIFIED) == GLFW_TRUE;
+        bool background = iconified || glfwGetWindowAttrib(_window, GLFW_FOCUSED) != GLFW_TRUE;
+
+        if (!iconified) {
+            //glViewport(0, 0, windowDimensions.x, windowDimensions.y);
+            // Trail mode overwrites the whole window when presenting
+            if (!trails) {
+                glClear(GL_COLOR_BUFFER_BIT);
+            }
 
-        double tT = _applicationCurrentTime - _applicationStartTime;
-        double dT = _applicationCurrentTime - _applicationLastUpdate;
+            double tT = _applicationCurrentTime - _applicationStartTime;
+            double dT = _applicationCurrentTime - _applicationLastUpdate;
 
-        _update(tT, dT);
+            _update(tT, dT);
 
-        glfwSwapBuffers(_window);
-        glfwPollEvents();
+            glfwSwapBuffers(_window);
+        }
+
+        _pacer.waitForNextFrame(background, iconified);
 
         _applicationLastUpdate = _applicationCurrentTime;
     }
 
+    _pacer.stop();
     glfwDestroyWindow(_window);
     glfwTerminate();
 }
 
-Application::Application(const char* _title, int _numParticles, float _minAge, float _maxAge, IntVector2 _windowDimensions) {
+void Application::benchmarkUpdateShaders(int iterations) {
+    if (!_window) return;
+
+    if (!_setup()) {
+        glfwDestroyWindow(_window);
+        glfwTerminate();
+        return;
+    }
+
+    const double dt = 1.0 / 60.0;
+    GLuint runtimeProgram = _getUpdateProgram(RuntimeFeatureProgram);
+
+    cout << "Update shader benchmark (" << numParticles << " particles, " << iterations << " passes)" << endl;
+    cout << "features  runtime(ms)  specialized(ms)  speedup" << endl;
+
+    for (unsigned featureSet = 0; featureSet < ParticleFeatureCount; ++featureSet) {
+        GLuint programs[2] = { runtimeProgram, _getUpdateProgram(featureSet) };
+        double totalMs[2] = { 0.0, 0.0 };
+
+        // Warm up both so shader compilation and first-use costs aren't timed
+        for (int p = 0; p < 2; ++p) {
+            _runUpdatePass(programs[p], featureSet, 0.0, dt);
+        }
+        glFinish();
+
+        // Alternate which variant goes first so neither always sees the colder state.
+        // Each pass is fenced with glFinish and timed on the wall clock; timer
+        // queries read ~0 on software GL, which runs the work at flush time.
+        for (int i = 0; i < iterations; ++i) {
+            for (int k = 0; k < 2; ++k) {
+                int p = (i + k) % 2;
+
+                double start = glfwGetTime();
+                _runUpdatePass(programs[p], featureSet, i * dt, dt);
+                glFinish();
+                totalMs[p] += (glfwGetTime() - start) * 1000.0;
+            }
+        }
+
+        cout << "0x" << hex << featureSet << dec
+            << fixed << setprecision(2)
+            << "       " << setw(10) << totalMs[0]
+            << "   " << setw(14) << totalMs[1]
+            << "   " << setw(6) << totalMs[0] / totalMs[1] << "x" << endl;
+    }
+
+    glfwDestroyWindow(_window);
+    glfwTerminate();
+}
+
+static string hexString(unsigned value) {
+    ostringstream text;
+    text << hex << value;
+    return text.str();
+}
+
+// Golden file names carry the feature mask, so each update path has its own
+static string goldenBasePath(const string& directory, int steps, unsigned featureSet) {
+    return directory + "/verify-" + to_string(steps) + "-" + hexString(featureSet);
+}
+
+bool Application::_verifyUpdatePath(const vector<Particle>& initial, unsigned program, int steps, float timeDelta, const string& goldenDirectory, bool updateGoldens) {
+    // The runtime program runs every force and is held to the FeatureAll goldens
+    bool runtime = program == RuntimeFeatureProgram;
+    unsigned featureSet = runtime ? FeatureAll : program;
+    string pathName = runtime ? string("runtime") : "0x" + hexString(featureSet);
+
+    // Both buffers restart from the same seeded state for every path
+    size_t dataSize = numParticles * sizeof(Particle);
+    glNamedBufferSubData(_particleBuffers[0], 0, dataSize, initial.data());
+    glNamedBufferSubData(_particleBuffers[1], 0, dataSize, initial.data());
+    _read = 0;
+    _write = 1;
+
+    vector<Particle> expected = initial;
+    vector<Particle> actual(numParticles);
+
+    // Step the GPU and the reference CPU kernel side by side
+    GLuint updateProgram = _getUpdateProgram(program);
+    ParticleUpdateParams params = _updateParams(timeDelta);
+    ParticleUpdateKernel kernel = selectUpdateKernel(featureSet);
+    for (int i = 0; i < steps; ++i) {
+        _runUpdatePass(updateProgram, featureSet, i * timeDelta, timeDelta);
+        kernel(expected.data(), expected.size(), 0, params, _noiseData.data());
+    }
+
+    glGetNamedBufferSubData(_particleBuffers[_read], 0, dataSize, actual.data());
+
+    // Render one frame offscreen
+    GLuint frameTexture, frameBuffer;
+    glCreateTextures(GL_TEXTURE_2D, 1, &frameTexture);
+    glTextureStorage2D(frameTexture, 1, GL_RGBA8, windowDimensions.x, windowDimensions.y);
+    glCreateFramebuffers(1, &frameBuffer);
+    glNamedFramebufferTexture(frameBuffer, GL_COLOR_ATTACHMENT0, frameTexture, 0);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, frameBuffer);
+    glViewport(0, 0, windowDimensions.x, windowDimensions.y);
+    glClear(GL_COLOR_BUFFER_BIT);
+    _render();
+
+    vector<uint8_t> frame(windowDimensions.x * windowDimensions.y);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, windowDimensions.x, windowDimensions.y, GL_RED, GL_UNSIGNED_BYTE, frame.data());
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    glDeleteFramebuffers(1, &frameBuffer);
+    glDeleteTextures(1, &frameTexture);
+
+    vector<uint8_t> reference = rasterizeParticles(expected.data(), expected.size(), windowDimensions.x, windowDimensions.y);
+
+    string goldenBase = goldenBasePath(goldenDirectory, steps, featureSet);
+    string goldenStatePath = goldenBase + ".state";
+    string goldenFramePath = goldenBase + ".pgm";
+
+    if (updateGoldens) {
+        // Written from the CPU reference, so a GPU bug can't bake itself in
+        bool written = writeParticleState(goldenStatePath, expected)
+            && writeImage(goldenFramePath, reference, windowDimensions.x, windowDimensions.y);
+        cout << "[verify " << pathName << "] goldens " << (written ? "written to " : "FAILED to write to ") << goldenBase << ".*" << endl;
+        return written;
+    }
+
+    vector<Particle> golden;
+    vector<uint8_t> goldenFrame;
+    bool goldenLoaded = readParticleState(goldenStatePath, golden) && golden.size() == actual.size()
+        && readImage(goldenFramePath, goldenFrame, windowDimensions.x, windowDimensions.y);
+
+    // A particle near age == life may respawn a step apart on either side,
+    // so allow a tiny fraction of outright mismatches.
+    const float stateTolerance = 1e-3f;
+    const size_t allowedMismatches = actual.size() / 1000;
+
+    StateComparison state = compareParticleStates(actual.data(), expected.data(), actual.size(), stateTolerance);
+    StateComparison goldenState = { actual.size(), 0.0f };
+    if (goldenLoaded) {
+        goldenState = compareParticleStates(actual.data(), golden.data(), actual.size(), stateTolerance);
+    }
+    bool statePassed = state.mismatches <= allowedMismatches && goldenLoaded && goldenState.mismatches <= allowedMismatches;
+
+    // GPU reduction against the CPU one, on the same state
+    glFinish();
+    _collectStats();
+    _requestStats(_particleBuffers[_read], steps * timeDelta);
+    glFinish();
+    _collectStats();
+
+    ParticleStats cpuStats = computeParticleStats(actual.data(), actual.size());
+    bool statsPassed = particleStats.aliveCount == cpuStats.aliveCount
+        && fabsf(particleStats.speedSum - cpuStats.speedSum) <= 1e-3f * cpuStats.speedSum
+        && fabsf(particleStats.maxSpeed - cpuStats.maxSpeed) <= 1e-5f
+        && equal(begin(particleStats.bounds), end(particleStats.bounds), begin(cpuStats.bounds));
+
+    // Frames that are right up to edge rounding score at most ~7e-4 here
+    // (FeatureBounds, with points stacked on the edges), while one drawn
+    // from particles a single step out of sync scores 1e-2 or more.
+    const float frameTolerance = 2e-3f;
+    float frameError = compareImages(frame, reference, windowDimensions.x, windowDimensions.y);
+    float goldenFrameError = goldenLoaded ? compareImages(frame, goldenFrame, windowDimensions.x, windowDimensions.y) : 1.0f;
+    bool framePassed = frameError <= frameTolerance && goldenFrameError <= frameTolerance;
+
+    string tag = "[verify " + pathName + "] ";
+    if (!goldenLoaded) {
+        cout << tag << "no usable goldens at " << goldenBase << ".*, run with --update-goldens to record them" << endl;
+    }
+    cout << tag << "state: " << state.mismatches << " mismatches, max error " << state.maxError
+        << "; golden " << goldenState.mismatches << " mismatches, max error " << goldenState.maxError
+        << (statePassed ? " - ok" : " - FAILED") << endl;
+    cout << tag << "stats: alive " << particleStats.aliveCount << " / " << cpuStats.aliveCount
+        << ", speed sum " << particleStats.speedSum << " / " << cpuStats.speedSum
+        << (statsPassed ? " - ok" : " - FAILED") << endl;
+    cout << tag << "frame: blurred error " << frameError << ", golden " << goldenFrameError
+        << " (limit " << frameTolerance << ")"
+        << (framePassed ? " - ok" : " - FAILED") << endl;
+
+    return statePassed && statsPassed && framePassed;
+}
+
+bool Application::_verifyTrails(float timeDelta) {
+    const int width = windowDimensions.x;
+    const int height = windowDimensions.y;
+    const float start = 0.5f;
+    const float expected = start * expf(-trailDecay * timeDelta);
+
+    // A known accumulation with alpha 0, so a pass that lets alpha through shows
+    const float clear[4] = { start, start, start, 0.0f };
+    glClearNamedFramebufferfv(_trailFramebuffers[_trailRead], GL_COLOR, 0, clear);
+
+    glViewport(0, 0, width, height);
+    _renderTrails(timeDelta);
+
+    vector<float> accumulation(width * height * 4);
+    glGetTextureImage(_trailTextures[_trailRead], 0, GL_RGBA, GL_FLOAT, static_cast<GLsizei>(accumulation.size() * sizeof(float)), accumulation.data());
+
+    vector<uint8_t> presented(width * height * 4);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, presented.data());
+
+    // Particles are drawn over their pixels; only the rest show the decay
+    vector<Particle> particles(numParticles);
+    glGetNamedBufferSubData(_particleBuffers[_read], 0, numParticles * sizeof(Particle), particles.data());
+    vector<uint8_t> lit = rasterizeParticles(particles.data(), particles.size(), width, height);
+
+    size_t checked = 0;
+    float decayError = 0.0f, presentError = 0.0f, minAlpha = 1.0f;
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            size_t i = y * width + x;
+            minAlpha = fminf(minAlpha, fminf(accumulation[i * 4 + 3], presented[i * 4 + 3] / 255.0f));
+
+            bool nearParticle = false;
+            for (int dy = -1; dy <= 1; ++dy) {
+                for (int dx = -1; dx <= 1; ++dx) {
+                    int sx = min(max(x + dx, 0), width - 1);
+                    int sy = min(max(y + dy, 0), height - 1);
+                    nearParticle |= lit[sy * width + sx] != 0;
+                }
+            }
+            if (nearParticle) {
+                continue;
+            }
+
+            checked++;
+            decayError = fmaxf(decayError, fabsf(accumulation[i * 4] - expected));
+            presentError = fmaxf(presentError, fabsf(presented[i * 4] / 255.0f - expected));
+        }
+    }
+
+    // Half float rounding on the accumulation, 8-bit rounding on the window
+    bool passed = checked > 0 && decayError <= 1e-3f && presentError <= 1.0f / 255.0f && minAlpha == 1.0f;
+
+    cout << "[verify trails] decay to " << expected << " (exp(-" << trailDecay << " * " << timeDelta << ") of " << start
+        << ") over " << checked << " pixels: max error " << decayError << ", presented " << presentError
+        << ", min alpha " << minAlpha
+        << (passed ? " - ok" : " - FAILED") << endl;
+
+    return passed;
+}
+
+vector<unsigned> Application::verifyUpdatePaths() {
+    return {
+        FeatureNone, FeatureDrag, FeatureWind, FeatureBounds, FeatureAttractor, FeatureAll,
+        RuntimeFeatureProgram
+    };
+}
+
+bool Application::verify(int steps, float timeDelta, unsigned seed, const string& goldenDirectory, bool updateGoldens, const vector<unsigned>& programs) {
+    if (!_window) return false;
+
+    // Same seed, same particles and noise
+    _random.seed(seed);
+    if (!_setup()) {
+        glfwDestroyWindow(_window);
+        glfwTerminate();
+        return false;
+    }
+
+    vector<Particle> initial(numParticles);
+    glGetNamedBufferSubData(_particleBuffers[_read], 0, numParticles * sizeof(Particle), initial.data());
+
+    if (updateGoldens) {
+        error_code error;
+        filesystem::create_directories(goldenDirectory, error);
+    }
+
+    cout << "[verify] " << steps << " steps, " << numParticles << " particles, " << programs.size() << " update paths"
+        << (trails ? " and trails" : "") << endl;
+
+    bool passed = true;
+    for (unsigned program : programs) {
+        passed &= _verifyUpdatePath(initial, program, steps, timeDelta, goldenDirectory, updateGoldens);
+    }
+
+    // Runs on whatever state the last path left; it only checks the decay
+    if (trails && !updateGoldens) {
+        passed &= _verifyTrails(timeDelta);
+    }
+
+    cout << "[verify] " << (passed ? "all ok" : "FAILED") << endl;
+
+    glfwDestroyWindow(_window);
+    glfwTerminate();
+
+    return passed;
+}
+
+Application::Application(const char* _title, int _numParticles, float _minAge, float _maxAge, IntVector2 _windowDimensions, bool headless, bool _trails) {
     title = _title;
     numParticles = _numParticles;
     windowDimensions = _windowDimensions;
     minAge = _minAge;
     maxAge = _maxAge;
+    _headless = headless;
+    trails = _trails;
 
     // Load GLFW
     createWindow();
-    glfwGetFramebufferSize(_window, &windowDimensions.x, &windowDimensions.y);
 
     if (!_window) {
         cerr << "Failed to construct window!" << endl;
@@ -552,6 +1336,8 @@ Application::Application(const char* _title, int _numParticles, float _minAge, f
         return;
     }
 
+    glfwGetFramebufferSize(_window, &windowDimensions.x, &windowDimensions.y);
+
     glfwMakeContextCurrent(_window);
 
     // Load OpenGL using Glad
@@ -559,6 +1345,7 @@ Application::Application(const char* _title, int _numParticles, float _minAge, f
         cerr << "Failed to init OpenGL!" << endl;
         glfwDestroyWindow(_window);
         glfwTerminate();
+        _window = nullptr;
         return;
     }
 
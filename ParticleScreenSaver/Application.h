@@ -4,12 +4,21 @@
 #define _USE_MATH_DEFINES
 
 #include <math.h>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <random>
+#include <sstream>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include "glad/glad.h"
 #include "GLFW/glfw3.h"
 #include "Vector2.h"
+#include "Particle.h"
+#include "FramePacer.h"
+#include "ParticleStats.h"
 
 using namespace std;
 
@@ -25,13 +34,6 @@ struct Shader {
 	const char* source;
 };
 
-struct Particle {
-	float position[2];
-	float velocity[2];
-	float age; // current
-	float life; // max
-};
-
 struct AttributeLocation {
 	GLuint location;
 	GLint num_components;
@@ -58,7 +60,9 @@ private:
 	double _applicationLastDisplayUpdate;
 	double _applicationFrameCount;
 
-	GLFWwindow* _window;
+	GLFWwindow* _window = nullptr;
+	bool _headless;
+	FramePacer _pacer;
 
 	// Particles
 	GLuint _particleBuffers[2]; // Buffers
@@ -66,13 +70,56 @@ private:
 	int _read = 0;
 	int _write = 1;
 
-	GLuint _updateProgram, _renderProgram; // Programs
+	unordered_map<unsigned, GLuint> _updatePrograms; // One per feature set, compiled lazily
+	GLuint _renderProgram; // Programs
 	
 	GLuint _noiseTexture;
-
+	vector<uint8_t> _noiseData; // host copy of the noise texture
+	mt19937 _random; // initial particles and noise; same sequence on every platform
+
+	// Live particle stats, read back asynchronously through a ring of fenced buffers
+	static const int StatsRingSize = 3;
+	GLuint _statsPartialProgram, _statsFinalProgram;
+	GLuint _statsPartialBuffer;
+	GLuint _statsBuffers[StatsRingSize];
+	GLsync _statsFences[StatsRingSize];
+	double _statsTimes[StatsRingSize];
+	int _statsNext = 0;
+	int _statsOldest = 0;
+	double _statsLastRequest = 0.0;
+	ofstream _statsExport;
+
+	void _setupStats();
+	void _requestStats(GLuint particleBuffer, double tt);
+	void _collectStats();
+
+
+	GLuint _getUpdateProgram(unsigned featureSet);
+	void _runUpdatePass(GLuint updateProgram, unsigned featureSet, double tt, double dt);
+	bool _setup();
+	ParticleUpdateParams _updateParams(float dt);
+	void _simulate(double tt, double dt);
+	void _render();
 	void _update(double tt, double dt);
+
+	// Trails, ping-ponged accumulation textures
+	GLuint _trailProgram;
+	GLuint _trailVAO;
+	GLuint _trailTextures[2];
+	GLuint _trailFramebuffers[2];
+	int _trailRead = 0;
+
+	void _setupTrails();
+	void _drawTrailPass(GLuint source, float fade);
+	void _renderTrails(double dt);
+
+	bool _verifyUpdatePath(const vector<Particle>& initial, unsigned program, int steps, float timeDelta, const string& goldenDirectory, bool updateGoldens);
+	bool _verifyTrails(float timeDelta);
 	static void _key_callback(GLFWwindow window, int key, int scancode, int action, int mods);
 public:
+	// _getUpdateProgram key for the variant that picks features at runtime
+	static const unsigned RuntimeFeatureProgram = ParticleFeatureCount;
+
 	const char* title;
 	int numParticles;
 	float minAge, maxAge;
@@ -80,10 +127,36 @@ public:
 	float origin[2] = { 0.0, 0.0 };
 	float theta[2] = { M_PI / 2.0 - 0.5, M_PI / 2.0 + 0.5 };
 	float speed[2] = { 0.5, 1.0f };
+	unsigned features = FeatureNone; // ParticleFeature flags
+	float drag = 0.5f;
+	float wind[2] = { 0.3f, 0.0f };
+	float attractor[2] = { 0.0f, 0.5f };
+	float attractorStrength = 2.0f;
 	IntVector2 windowDimensions;
-
-	Application(const char* title, int _numParticles, float minAge, float maxAge, IntVector2 _windowDimensions);
+	double targetFrameRate = 0.0; // 0 = uncapped (vsync)
+	double backgroundFrameRate = 5.0; // while unfocused, 0 = same as targetFrameRate
+	ParticleStats particleStats; // latest read back, a few frames old
+	bool trails = false; // keep fading trails instead of clearing every frame; set by the constructor
+	float trailDecay = 4.0f; // exponential fade rate of the trails, per second
+	double statsInterval = 0.25; // seconds between reductions
+	const char* statsExportPath = nullptr; // CSV file, one row per reduction
+
+	// `trails` is fixed at construction because it decides the window's sample count
+	Application(const char* title, int _numParticles, float minAge, float maxAge, IntVector2 _windowDimensions, bool headless = false, bool trails = false);
 	void run();
+	// Runs `steps` fixed updates from a seeded start on each update program in
+	// `programs` (a feature set or RuntimeFeatureProgram, see
+	// verifyUpdatePaths()) and checks the particle state, stats and a rendered
+	// frame against the CPU reference kernel and against the goldens stored in
+	// `goldenDirectory`. With `updateGoldens` the goldens are rewritten from
+	// the CPU reference instead. In trail mode it then checks one frame's
+	// decay against exp(-trailDecay * timeDelta).
+	bool verify(int steps, float timeDelta, unsigned seed, const string& goldenDirectory, bool updateGoldens, const vector<unsigned>& programs);
+	// No features, each feature alone, all of them, and the runtime-flag program
+	static vector<unsigned> verifyUpdatePaths();
+	// Times every #define permutation of the update shader against the
+	// runtime-flag variant.
+	void benchmarkUpdateShaders(int iterations);
 	void createWindow();
 	void compileShaders();
 	void setupBuffers();
@@ -0,0 +1,133 @@
+#include "FramePacer.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <timeapi.h>
+#pragma comment(lib, "winmm.lib")
+#else
+#include <time.h>
+#endif
+
+#include "GLFW/glfw3.h"
+
+// A frame this close to its deadline counts as on time. GLFW 3.3 truncates
+// wait timeouts to whole milliseconds on Windows, so waiting out anything
+// shorter just spins through zero-length waits.
+static const double DeadlineSlack = 0.001;
+
+// Nothing is presented while iconified, so vsync no longer blocks the loop;
+// an uncapped rate would then spin. Iconified windows wake at least this often.
+static const double IconifiedFrameRate = 5.0;
+
+// CPU time used by the whole process (all threads, user + kernel), in seconds
+static double processCpuSeconds() {
+#ifdef _WIN32
+    FILETIME creation, exit, kernel, user;
+    GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user);
+
+    ULARGE_INTEGER kernelTime, userTime;
+    kernelTime.LowPart = kernel.dwLowDateTime;
+    kernelTime.HighPart = kernel.dwHighDateTime;
+    userTime.LowPart = user.dwLowDateTime;
+    userTime.HighPart = user.dwHighDateTime;
+
+    // FILETIME is in 100ns units
+    return (kernelTime.QuadPart + userTime.QuadPart) * 1e-7;
+#else
+    timespec time;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &time);
+    return time.tv_sec + time.tv_nsec * 1e-9;
+#endif
+}
+
+FramePacer::FramePacer(double _targetFrameRate, double _backgroundFrameRate) {
+    targetFrameRate = _targetFrameRate;
+    backgroundFrameRate = _backgroundFrameRate;
+    cpuMsPerFrame = 0.0;
+    wakeupsPerSecond = 0.0;
+
+    _deadline = 0.0;
+    _windowStart = 0.0;
+    _windowCpuStart = 0.0;
+    _windowFrames = 0;
+    _windowWakeups = 0;
+
+    _timerPeriodRaised = false;
+}
+
+void FramePacer::start() {
+#ifdef _WIN32
+    if (!_timerPeriodRaised && (targetFrameRate > 0.0 || backgroundFrameRate > 0.0)) {
+        _timerPeriodRaised = timeBeginPeriod(1) == TIMERR_NOERROR;
+    }
+#endif
+
+    _deadline = glfwGetTime();
+    _windowStart = _deadline;
+    _windowCpuStart = processCpuSeconds();
+    _windowFrames = 0;
+    _windowWakeups = 0;
+}
+
+void FramePacer::stop() {
+#ifdef _WIN32
+    if (_timerPeriodRaised) {
+        timeEndPeriod(1);
+    }
+#endif
+    _timerPeriodRaised = false;
+}
+
+void FramePacer::waitForNextFrame(bool background, bool iconified) {
+    double rate = background || iconified ? backgroundFrameRate : targetFrameRate;
+    if (iconified && rate <= 0.0) {
+        rate = IconifiedFrameRate;
+    }
+    double now = glfwGetTime();
+
+    if (rate <= 0.0) {
+        glfwPollEvents();
+        ++_windowWakeups;
+        _deadline = now;
+    }
+    else {
+        // Advance from the previous deadline so the rate doesn't drift, but
+        // never try to catch up on frames that were missed.
+        _deadline += 1.0 / rate;
+        if (_deadline < now) {
+            _deadline = now;
+        }
+
+        if (_deadline - now <= DeadlineSlack) {
+            glfwPollEvents();
+            ++_windowWakeups;
+        }
+
+        // Input events wake us early; go back to sleep until the deadline
+        while (_deadline - now > DeadlineSlack) {
+            glfwWaitEventsTimeout(_deadline - now);
+            ++_windowWakeups;
+            now = glfwGetTime();
+        }
+    }
+
+    // Iconified iterations draw nothing, so they aren't frames
+    if (!iconified) {
+        ++_windowFrames;
+    }
+
+    double elapsed = now - _windowStart;
+    if (elapsed >= 1.0) {
+        double cpu = processCpuSeconds();
+
+        cpuMsPerFrame = _windowFrames > 0 ? (cpu - _windowCpuStart) * 1000.0 / _windowFrames : 0.0;
+        wakeupsPerSecond = _windowWakeups / elapsed;
+
+        _windowStart = now;
+        _windowCpuStart = cpu;
+        _windowFrames = 0;
+        _windowWakeups = 0;
+    }
+}
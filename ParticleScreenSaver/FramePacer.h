@@ -0,0 +1,41 @@
+#ifndef FRAMEPACER_H
+#define FRAMEPACER_H
+
+// Caps the frame rate by sleeping in glfwWaitEventsTimeout until the next
+// frame's deadline instead of spinning, and measures what that costs.
+class FramePacer {
+private:
+    double _deadline;
+
+    // Current one second measurement window
+    double _windowStart;
+    double _windowCpuStart;
+    int _windowFrames;
+    int _windowWakeups;
+
+    bool _timerPeriodRaised;
+public:
+    double targetFrameRate; // 0 = run as fast as vsync allows
+    double backgroundFrameRate; // used while unfocused or iconified
+
+    // Results of the last completed window
+    double cpuMsPerFrame; // per presented frame, 0 if none were
+    double wakeupsPerSecond;
+
+    FramePacer(double targetFrameRate = 0.0, double backgroundFrameRate = 0.0);
+
+    // Starts timing from now. Needs GLFW to be initialized. On Windows this
+    // also raises the system timer resolution to 1ms while a rate is set, so
+    // waits don't round up to the default 15.6ms tick.
+    void start();
+
+    // Restores the timer resolution raised by start()
+    void stop();
+
+    // Processes window events, sleeping until the next frame is due.
+    // `iconified` means nothing was presented this iteration: it isn't
+    // counted as a frame, and the wait never drops to a busy poll.
+    void waitForNextFrame(bool background, bool iconified);
+};
+
+#endif // !FRAMEPACER_H
@@ -0,0 +1,41 @@
+#ifndef PARTICLE_H
+#define PARTICLE_H
+
+// Same order as the update shader's transform feedback varyings, which is
+// how the particle buffers are laid out on the GPU.
+struct Particle {
+	float position[2];
+	float age; // current
+	float life; // max
+	float velocity[2];
+};
+
+// Optional forces/constraints applied on top of gravity. Each combination
+// gets its own branch-free update kernel, both as a shader permutation
+// (#define FEATURE_*) and as a C++ template instantiation.
+enum ParticleFeature : unsigned {
+	FeatureNone = 0,
+	FeatureDrag = 1 << 0,
+	FeatureWind = 1 << 1,
+	FeatureBounds = 1 << 2,
+	FeatureAttractor = 1 << 3,
+	FeatureAll = FeatureDrag | FeatureWind | FeatureBounds | FeatureAttractor
+};
+
+const unsigned ParticleFeatureCount = FeatureAll + 1;
+
+// Mirrors the update shader's uniforms.
+struct ParticleUpdateParams {
+	float timeDelta;
+	float gravity[2];
+	float origin[2];
+	float screenSize[2];
+	float theta[2];
+	float speed[2];
+	float drag;
+	float wind[2];
+	float attractor[2];
+	float attractorStrength;
+};
+
+#endif // !PARTICLE_H
@@ -0,0 +1,155 @@
+#include "ParticleArena.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/mman.h>
+#include <sys/resource.h>
+#endif
+
+using namespace std;
+
+static size_t roundUp(size_t value, size_t multiple) {
+    return (value + multiple - 1) / multiple * multiple;
+}
+
+// Page faults taken by the process so far (minor + major)
+static long processPageFaults() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return 0;
+    }
+    return static_cast<long>(counters.PageFaultCount);
+#else
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_minflt + usage.ru_majflt;
+#endif
+}
+
+#ifdef _WIN32
+// Large pages need SeLockMemoryPrivilege ("Lock pages in memory"). It has to
+// be granted to the account by policy, and even then it starts out disabled
+// in the process token until it is switched on here.
+static bool enableLockMemoryPrivilege() {
+    HANDLE token;
+    if (!OpenProcessToken(GetCurrentProcess(), TOKEN_ADJUST_PRIVILEGES | TOKEN_QUERY, &token)) {
+        return false;
+    }
+
+    TOKEN_PRIVILEGES privileges;
+    privileges.PrivilegeCount = 1;
+    privileges.Privileges[0].Attributes = SE_PRIVILEGE_ENABLED;
+
+    bool enabled = false;
+    if (LookupPrivilegeValue(nullptr, SE_LOCK_MEMORY_NAME, &privileges.Privileges[0].Luid)) {
+        // Succeeds even when the privilege isn't held; that case is only
+        // reported through GetLastError
+        enabled = AdjustTokenPrivileges(token, FALSE, &privileges, 0, nullptr, nullptr)
+            && GetLastError() != ERROR_NOT_ALL_ASSIGNED;
+    }
+
+    CloseHandle(token);
+    return enabled;
+}
+#endif
+
+static char* reservePages(size_t& bytes, const char*& pageKind) {
+#ifdef _WIN32
+    size_t largePage = GetLargePageMinimum();
+    if (largePage > 0 && enableLockMemoryPrivilege()) {
+        size_t largeBytes = roundUp(bytes, largePage);
+        void* memory = VirtualAlloc(nullptr, largeBytes, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+        if (memory != nullptr) {
+            bytes = largeBytes;
+            pageKind = "explicit huge";
+            return static_cast<char*>(memory);
+        }
+    }
+
+    pageKind = "regular";
+    return static_cast<char*>(VirtualAlloc(nullptr, bytes, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE));
+#else
+    const size_t hugePage = 2 * 1024 * 1024;
+    size_t hugeBytes = roundUp(bytes, hugePage);
+    void* memory;
+
+#ifdef MAP_HUGETLB
+    // Only succeeds when hugetlbfs pages have been reserved by the admin
+    memory = mmap(nullptr, hugeBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (memory != MAP_FAILED) {
+        bytes = hugeBytes;
+        pageKind = "explicit huge";
+        return static_cast<char*>(memory);
+    }
+#endif
+
+    memory = mmap(nullptr, hugeBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED) {
+        pageKind = "regular";
+        return nullptr;
+    }
+    bytes = hugeBytes;
+
+    pageKind = "regular";
+#ifdef MADV_HUGEPAGE
+    if (madvise(memory, hugeBytes, MADV_HUGEPAGE) == 0) {
+        pageKind = "transparent huge";
+    }
+#endif
+    return static_cast<char*>(memory);
+#endif
+}
+
+static void releasePages(char* base, size_t bytes) {
+#ifdef _WIN32
+    (void)bytes;
+    VirtualFree(base, 0, MEM_RELEASE);
+#else
+    munmap(base, bytes);
+#endif
+}
+
+ParticleArena::ParticleArena(size_t bytes) {
+    auto start = chrono::steady_clock::now();
+    long faultsBefore = processPageFaults();
+
+    _bytes = roundUp(max<size_t>(bytes, 1), Alignment);
+    _used = 0;
+    _base = reservePages(_bytes, pageKind);
+
+    if (_base == nullptr) {
+        _bytes = 0;
+    }
+    else {
+        // Fault every page in now rather than during the first frames
+        memset(_base, 0, _bytes);
+    }
+
+    pageFaults = processPageFaults() - faultsBefore;
+    allocationMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+ParticleArena::~ParticleArena() {
+    if (_base != nullptr) {
+        releasePages(_base, _bytes);
+    }
+}
+
+void* ParticleArena::allocate(size_t bytes) {
+    size_t offset = roundUp(_used, Alignment);
+    if (_base == nullptr || offset + bytes > _bytes) {
+        return nullptr;
+    }
+
+    _used = offset + bytes;
+    return _base + offset;
+}
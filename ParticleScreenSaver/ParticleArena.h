@@ -0,0 +1,40 @@
+#ifndef PARTICLEARENA_H
+#define PARTICLEARENA_H
+
+#include <cstddef>
+
+// Bump allocator over one region reserved up front, backed by huge pages
+// when the OS allows it. The whole region is faulted in by the constructor
+// so the page faults are paid (and counted) once, at startup.
+class ParticleArena {
+private:
+    char* _base;
+    size_t _bytes;
+    size_t _used;
+
+    ParticleArena(const ParticleArena&) = delete;
+    ParticleArena& operator=(const ParticleArena&) = delete;
+public:
+    static const size_t Alignment = 64;
+
+    // Filled in by the constructor, for the startup log
+    const char* pageKind; // "explicit huge", "transparent huge" or "regular"
+    double allocationMs;
+    long pageFaults;
+
+    ParticleArena(size_t bytes);
+    ~ParticleArena();
+
+    // Returns `bytes` aligned to Alignment, or nullptr when the arena is full
+    void* allocate(size_t bytes);
+
+    template <typename T>
+    T* allocateArray(size_t count) {
+        return static_cast<T*>(allocate(count * sizeof(T)));
+    }
+
+    size_t capacity() const { return _bytes; }
+    size_t used() const { return _used; }
+};
+
+#endif // !PARTICLEARENA_H
@@ -0,0 +1,210 @@
+#define _USE_MATH_DEFINES
+
+#include "ParticleKernel.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+// C++ mirror of updateVertexShaderSource. Keep the two in sync: the order of
+// operations matters for matching the transform feedback output.
+
+static inline void respawnParticle(Particle& p, size_t index, const ParticleUpdateParams& params, const uint8_t* noise) {
+    size_t x = index % NoiseTextureSize;
+    size_t y = (index / NoiseTextureSize) % NoiseTextureSize;
+    const uint8_t* texel = noise + (y * NoiseTextureSize + x) * 2;
+    float randR = texel[0] / 255.0f;
+    float randG = texel[1] / 255.0f;
+
+    float theta = params.theta[0] + randR * (params.theta[1] - params.theta[0]);
+    float speed = params.speed[0] + randG * (params.speed[1] - params.speed[0]);
+
+    p.position[0] = params.origin[0] / params.screenSize[0];
+    p.position[1] = params.origin[1] / params.screenSize[1];
+    p.velocity[0] = cosf(theta) * speed;
+    p.velocity[1] = sinf(theta) * speed;
+    p.age = 0.0f;
+}
+
+static inline void reflectAtBounds(float& position, float& velocity) {
+    float outside = fabsf(position) >= 1.0f ? 1.0f : 0.0f;
+    velocity -= 2.0f * outside * velocity;
+    position = fminf(fmaxf(position, -1.0f), 1.0f);
+}
+
+template <unsigned Features>
+static void updateParticlesSpecialized(Particle* particles, size_t count, size_t firstIndex, const ParticleUpdateParams& params, const uint8_t* noise) {
+    const float dt = params.timeDelta;
+
+    for (size_t i = 0; i < count; ++i) {
+        Particle& p = particles[i];
+
+        if (p.age >= p.life) {
+            respawnParticle(p, firstIndex + i, params, noise);
+            continue;
+        }
+
+        float vx = p.velocity[0];
+        float vy = p.velocity[1];
+
+        p.position[0] += vx * dt;
+        p.position[1] += vy * dt;
+        p.age += dt;
+
+        vx += params.gravity[0] * dt;
+        vy += params.gravity[1] * dt;
+
+        if constexpr ((Features & FeatureWind) != 0) {
+            vx += params.wind[0] * dt;
+            vy += params.wind[1] * dt;
+        }
+
+        if constexpr ((Features & FeatureAttractor) != 0) {
+            vx += (params.attractor[0] - p.position[0]) * params.attractorStrength * dt;
+            vy += (params.attractor[1] - p.position[1]) * params.attractorStrength * dt;
+        }
+
+        if constexpr ((Features & FeatureDrag) != 0) {
+            float damping = 1.0f - params.drag * dt;
+            vx *= damping;
+            vy *= damping;
+        }
+
+        if constexpr ((Features & FeatureBounds) != 0) {
+            reflectAtBounds(p.position[0], vx);
+            reflectAtBounds(p.position[1], vy);
+        }
+
+        p.velocity[0] = vx;
+        p.velocity[1] = vy;
+    }
+}
+
+void updateParticlesGeneric(Particle* particles, size_t count, size_t firstIndex, const ParticleUpdateParams& params, const uint8_t* noise, unsigned features) {
+    const float dt = params.timeDelta;
+
+    for (size_t i = 0; i < count; ++i) {
+        Particle& p = particles[i];
+
+        if (p.age >= p.life) {
+            respawnParticle(p, firstIndex + i, params, noise);
+            continue;
+        }
+
+        float vx = p.velocity[0];
+        float vy = p.velocity[1];
+
+        p.position[0] += vx * dt;
+        p.position[1] += vy * dt;
+        p.age += dt;
+
+        vx += params.gravity[0] * dt;
+        vy += params.gravity[1] * dt;
+
+        if (features & FeatureWind) {
+            vx += params.wind[0] * dt;
+            vy += params.wind[1] * dt;
+        }
+
+        if (features & FeatureAttractor) {
+            vx += (params.attractor[0] - p.position[0]) * params.attractorStrength * dt;
+            vy += (params.attractor[1] - p.position[1]) * params.attractorStrength * dt;
+        }
+
+        if (features & FeatureDrag) {
+            float damping = 1.0f - params.drag * dt;
+            vx *= damping;
+            vy *= damping;
+        }
+
+        if (features & FeatureBounds) {
+            reflectAtBounds(p.position[0], vx);
+            reflectAtBounds(p.position[1], vy);
+        }
+
+        p.velocity[0] = vx;
+        p.velocity[1] = vy;
+    }
+}
+
+template <size_t... Features>
+static const ParticleUpdateKernel* kernelTable(index_sequence<Features...>) {
+    static const ParticleUpdateKernel table[] = { &updateParticlesSpecialized<Features>... };
+    return table;
+}
+
+ParticleUpdateKernel selectUpdateKernel(unsigned features) {
+    return kernelTable(make_index_sequence<ParticleFeatureCount>())[features & FeatureAll];
+}
+
+void benchmarkUpdateKernels(size_t numParticles, int iterations) {
+    vector<uint8_t> noise(NoiseTextureSize * NoiseTextureSize * 2);
+    for (uint8_t& value : noise) {
+        value = static_cast<uint8_t>(rand() % 256);
+    }
+
+    vector<Particle> initial(numParticles);
+    for (Particle& p : initial) {
+        p.life = 1.0f + static_cast<float>(rand()) / RAND_MAX;
+        p.age = static_cast<float>(rand()) / RAND_MAX * p.life;
+        p.position[0] = static_cast<float>(rand()) / RAND_MAX * 2.0f - 1.0f;
+        p.position[1] = static_cast<float>(rand()) / RAND_MAX * 2.0f - 1.0f;
+        p.velocity[0] = 0.0f;
+        p.velocity[1] = 0.0f;
+    }
+
+    ParticleUpdateParams params = {
+        1.0f / 60.0f,
+        { 0.0f, -0.8f },
+        { 0.0f, 0.0f },
+        { 800.0f, 800.0f },
+        { static_cast<float>(M_PI / 2.0 - 0.5), static_cast<float>(M_PI / 2.0 + 0.5) },
+        { 0.5f, 1.0f },
+        0.5f,
+        { 0.3f, 0.0f },
+        { 0.0f, 0.5f },
+        2.0f
+    };
+
+    cout << "Update kernel benchmark (" << numParticles << " particles, " << iterations << " steps)" << endl;
+    cout << "features  generic(ms)  specialized(ms)  speedup" << endl;
+
+    for (unsigned features = 0; features < ParticleFeatureCount; ++features) {
+        ParticleUpdateKernel kernel = selectUpdateKernel(features);
+
+        // Each kernel steps its own copy, warmed up with one untimed step
+        vector<Particle> particles[2] = { initial, initial };
+        updateParticlesGeneric(particles[0].data(), particles[0].size(), 0, params, noise.data(), features);
+        kernel(particles[1].data(), particles[1].size(), 0, params, noise.data());
+
+        // Alternate which kernel goes first so neither always runs on a cold cache
+        double totalMs[2] = { 0.0, 0.0 };
+        for (int i = 0; i < iterations; ++i) {
+            for (int k = 0; k < 2; ++k) {
+                int which = (i + k) % 2;
+                Particle* data = particles[which].data();
+
+                auto start = chrono::steady_clock::now();
+                if (which == 0) {
+                    updateParticlesGeneric(data, initial.size(), 0, params, noise.data(), features);
+                }
+                else {
+                    kernel(data, initial.size(), 0, params, noise.data());
+                }
+                totalMs[which] += chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+            }
+        }
+
+        cout << "0x" << hex << features << dec
+            << fixed << setprecision(2)
+            << "       " << setw(10) << totalMs[0]
+            << "   " << setw(14) << totalMs[1]
+            << "   " << setw(6) << totalMs[0] / totalMs[1] << "x" << endl;
+    }
+}
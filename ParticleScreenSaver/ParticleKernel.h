@@ -0,0 +1,24 @@
+#ifndef PARTICLEKERNEL_H
+#define PARTICLEKERNEL_H
+
+#include <cstddef>
+#include <cstdint>
+#include "Particle.h"
+
+// Size of the square RG noise texture shared by the GPU and CPU kernels.
+const int NoiseTextureSize = 512;
+
+// Advances particles [0, count) by one step. `firstIndex` is the global index
+// of particles[0] (the GPU's gl_VertexID), used to look up the RG noise.
+typedef void (*ParticleUpdateKernel)(Particle* particles, size_t count, size_t firstIndex, const ParticleUpdateParams& params, const uint8_t* noise);
+
+// Branch-free kernel compiled for exactly `features`.
+ParticleUpdateKernel selectUpdateKernel(unsigned features);
+
+// Reference kernel that tests every feature flag per particle.
+void updateParticlesGeneric(Particle* particles, size_t count, size_t firstIndex, const ParticleUpdateParams& params, const uint8_t* noise, unsigned features);
+
+// Times the specialized kernels against the generic one for every feature combination.
+void benchmarkUpdateKernels(size_t numParticles, int iterations);
+
+#endif // !PARTICLEKERNEL_H
@@ -0,0 +1,105 @@
+#include "ParticleStats.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+ParticleStats emptyParticleStats() {
+    ParticleStats stats = {};
+    stats.bounds[0] = FLT_MAX;
+    stats.bounds[1] = FLT_MAX;
+    stats.bounds[2] = -FLT_MAX;
+    stats.bounds[3] = -FLT_MAX;
+    return stats;
+}
+
+void mergeParticleStats(ParticleStats& into, const ParticleStats& other) {
+    into.aliveCount += other.aliveCount;
+    into.bounds[0] = min(into.bounds[0], other.bounds[0]);
+    into.bounds[1] = min(into.bounds[1], other.bounds[1]);
+    into.bounds[2] = max(into.bounds[2], other.bounds[2]);
+    into.bounds[3] = max(into.bounds[3], other.bounds[3]);
+    into.speedSum += other.speedSum;
+    into.maxSpeed = max(into.maxSpeed, other.maxSpeed);
+
+    for (int i = 0; i < ParticleStatsHistogramBins; ++i) {
+        into.ageHistogram[i] += other.ageHistogram[i];
+    }
+}
+
+static void accumulateParticleStats(ParticleStats& stats, const Particle* particles, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        const Particle& p = particles[i];
+        if (p.age >= p.life) {
+            continue;
+        }
+
+        stats.aliveCount++;
+        stats.bounds[0] = min(stats.bounds[0], p.position[0]);
+        stats.bounds[1] = min(stats.bounds[1], p.position[1]);
+        stats.bounds[2] = max(stats.bounds[2], p.position[0]);
+        stats.bounds[3] = max(stats.bounds[3], p.position[1]);
+
+        float speed = sqrtf(p.velocity[0] * p.velocity[0] + p.velocity[1] * p.velocity[1]);
+        stats.speedSum += speed;
+        stats.maxSpeed = max(stats.maxSpeed, speed);
+
+        int bin = min(static_cast<int>(p.age / p.life * ParticleStatsHistogramBins), ParticleStatsHistogramBins - 1);
+        stats.ageHistogram[bin]++;
+    }
+}
+
+ParticleStats computeParticleStats(const Particle* particles, size_t count, unsigned threads) {
+    if (threads == 0) {
+        threads = max(1u, thread::hardware_concurrency());
+    }
+    threads = static_cast<unsigned>(min<size_t>(threads, max<size_t>(count, 1)));
+
+    vector<ParticleStats> partials(threads, emptyParticleStats());
+    vector<thread> workers;
+
+    size_t chunk = (count + threads - 1) / threads;
+    for (unsigned t = 1; t < threads; ++t) {
+        size_t begin = min(count, t * chunk);
+        size_t end = min(count, begin + chunk);
+        workers.emplace_back(accumulateParticleStats, ref(partials[t]), particles + begin, end - begin);
+    }
+    accumulateParticleStats(partials[0], particles, min(count, chunk));
+
+    for (thread& worker : workers) {
+        worker.join();
+    }
+
+    ParticleStats stats = emptyParticleStats();
+    for (const ParticleStats& partial : partials) {
+        mergeParticleStats(stats, partial);
+    }
+    return stats;
+}
+
+string particleStatsCsvHeader() {
+    ostringstream header;
+    header << "time,alive,min_x,min_y,max_x,max_y,mean_speed,max_speed";
+    for (int i = 0; i < ParticleStatsHistogramBins; ++i) {
+        header << ",age_bin_" << i;
+    }
+    return header.str();
+}
+
+string particleStatsCsvRow(double time, const ParticleStats& stats) {
+    ostringstream row;
+    row << time << "," << stats.aliveCount;
+    for (int i = 0; i < 4; ++i) {
+        row << "," << (stats.aliveCount > 0 ? stats.bounds[i] : 0.0f);
+    }
+    row << "," << stats.meanSpeed() << "," << stats.maxSpeed;
+    for (int i = 0; i < ParticleStatsHistogramBins; ++i) {
+        row << "," << stats.ageHistogram[i];
+    }
+    return row.str();
+}
@@ -0,0 +1,38 @@
+#ifndef PARTICLESTATS_H
+#define PARTICLESTATS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "Particle.h"
+
+const int ParticleStatsHistogramBins = 16;
+
+// Summary of the live particles. The layout matches the std430 `Stats` struct
+// written by the reduction compute shaders, so it can be read back directly.
+struct ParticleStats {
+	uint32_t aliveCount;
+	float bounds[4]; // min x, min y, max x, max y
+	float speedSum;
+	float maxSpeed;
+	uint32_t padding;
+	uint32_t ageHistogram[ParticleStatsHistogramBins]; // age / life, in equal bins over [0, 1)
+
+	float meanSpeed() const { return aliveCount > 0 ? speedSum / aliveCount : 0.0f; }
+};
+
+static_assert(sizeof(ParticleStats) == 96, "ParticleStats must match the std430 Stats struct");
+
+// Stats of an empty set, the identity for mergeParticleStats
+ParticleStats emptyParticleStats();
+void mergeParticleStats(ParticleStats& into, const ParticleStats& other);
+
+// CPU equivalent of the GPU reduction, split across `threads` worker threads
+// (0 = one per hardware thread).
+ParticleStats computeParticleStats(const Particle* particles, size_t count, unsigned threads = 0);
+
+// One CSV line (no newline) and its matching header, for monitoring exports
+std::string particleStatsCsvHeader();
+std::string particleStatsCsvRow(double time, const ParticleStats& stats);
+
+#endif // !PARTICLESTATS_H
@@ -0,0 +1,255 @@
+#include "Vector2Batch.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+#include "Vector2.h"
+
+using namespace std;
+
+static float randomFloat(float min, float max) {
+    return min + static_cast<float>(rand()) / RAND_MAX * (max - min);
+}
+
+template <typename Function>
+static double timeMs(int iterations, Function function) {
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        function();
+    }
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+static float maxError(const vector<Vector2>& expected, const vector<float>& xs, const vector<float>& ys) {
+    float error = 0.0f;
+    for (size_t i = 0; i < expected.size(); ++i) {
+        error = fmaxf(error, fabsf(expected[i].x - xs[i]));
+        error = fmaxf(error, fabsf(expected[i].y - ys[i]));
+    }
+    return error;
+}
+
+static float maxError(const vector<float>& expected, const vector<float>& actual) {
+    float error = 0.0f;
+    for (size_t i = 0; i < expected.size(); ++i) {
+        error = fmaxf(error, fabsf(expected[i] - actual[i]));
+    }
+    return error;
+}
+
+static bool report(const char* name, const char* lanes, float error, float tolerance, double scalarMs, double batchMs) {
+    bool passed = error <= tolerance;
+    cout << left << setw(12) << name << setw(9) << lanes << right
+        << fixed << setprecision(2)
+        << setw(12) << scalarMs
+        << setw(12) << batchMs
+        << setw(9) << scalarMs / batchMs << "x"
+        << scientific << setprecision(1)
+        << setw(11) << error
+        << (passed ? "  ok" : "  FAILED") << endl;
+    return passed;
+}
+
+// Applies `op` to every pair of vectors, F::width at a time with a scalar tail.
+// `op` is generic so the same lambda runs on Vector2xN<F> and Vector2x1.
+template <typename F, typename Op>
+static void mapBatch(const Vector2Span& a, const Vector2Span& b, const Vector2Span& out, Op op) {
+    typedef Vector2xN<F> V;
+    size_t i = 0;
+    for (; i + V::width <= out.count; i += V::width) {
+        op(V::load(a.x + i, a.y + i), V::load(b.x + i, b.y + i)).store(out.x + i, out.y + i);
+    }
+    for (; i < out.count; ++i) {
+        op(Vector2x1::load(a.x + i, a.y + i), Vector2x1::load(b.x + i, b.y + i)).store(out.x + i, out.y + i);
+    }
+}
+
+template <typename F, typename Op>
+static void mapAngles(const vector<float>& angles, vector<float>& out, Op op) {
+    size_t i = 0;
+    for (; i + F::width <= out.size(); i += F::width) {
+        op(F::load(angles.data() + i)).store(out.data() + i);
+    }
+    for (; i < out.size(); ++i) {
+        op(Floatx1::load(angles.data() + i)).store(out.data() + i);
+    }
+}
+
+struct BatchInputs {
+    vector<Vector2> a, b;
+    vector<float> ax, ay, bx, by;
+    vector<float> theta, speed;
+};
+
+// Checks and times every batch op for one lane type against the scalar Vector2
+template <typename F>
+static bool checkLaneType(const char* lanes, const BatchInputs& in, int iterations) {
+    const size_t count = in.a.size();
+    bool passed = true;
+
+    vector<float> ax = in.ax, ay = in.ay, bx = in.bx, by = in.by;
+    vector<float> ox(count), oy(count);
+    Vector2Span a = { ax.data(), ay.data(), count };
+    Vector2Span b = { bx.data(), by.data(), count };
+    Vector2Span out = { ox.data(), oy.data(), count };
+
+    vector<Vector2> expected(count);
+    vector<Vector2> scalarOut(count);
+
+    // operator+
+    {
+        auto op = [](auto u, auto v) { return u + v; };
+        for (size_t i = 0; i < count; ++i) expected[i] = in.a[i] + in.b[i];
+        mapBatch<F>(a, b, out, op);
+        float error = maxError(expected, ox, oy);
+
+        double scalarMs = timeMs(iterations, [&]() { for (size_t i = 0; i < count; ++i) scalarOut[i] = in.a[i] + in.b[i]; });
+        double batchMs = timeMs(iterations, [&]() { mapBatch<F>(a, b, out, op); });
+        passed &= report("add", lanes, error, 0.0f, scalarMs, batchMs);
+    }
+
+    // operator-
+    {
+        auto op = [](auto u, auto v) { return u - v; };
+        for (size_t i = 0; i < count; ++i) expected[i] = in.a[i] - in.b[i];
+        mapBatch<F>(a, b, out, op);
+        float error = maxError(expected, ox, oy);
+
+        double scalarMs = timeMs(iterations, [&]() { for (size_t i = 0; i < count; ++i) scalarOut[i] = in.a[i] - in.b[i]; });
+        double batchMs = timeMs(iterations, [&]() { mapBatch<F>(a, b, out, op); });
+        passed &= report("sub", lanes, error, 0.0f, scalarMs, batchMs);
+    }
+
+    // operator* (scalar)
+    {
+        const float scale = 0.75f;
+        auto op = [scale](auto u, auto) { return u * scale; };
+        for (size_t i = 0; i < count; ++i) expected[i] = in.a[i] * scale;
+        mapBatch<F>(a, b, out, op);
+        float error = maxError(expected, ox, oy);
+
+        double scalarMs = timeMs(iterations, [&]() { for (size_t i = 0; i < count; ++i) scalarOut[i] = in.a[i] * scale; });
+        double batchMs = timeMs(iterations, [&]() { mapBatch<F>(a, b, out, op); });
+        passed &= report("scale", lanes, error, 0.0f, scalarMs, batchMs);
+    }
+
+    // dot, written to both components
+    {
+        auto op = [](auto u, auto v) { return decltype(u)(u.dot(v), u.dot(v)); };
+        for (size_t i = 0; i < count; ++i) {
+            float dot = in.a[i].x * in.b[i].x + in.a[i].y * in.b[i].y;
+            expected[i] = Vector2(dot, dot);
+        }
+        mapBatch<F>(a, b, out, op);
+        float error = maxError(expected, ox, oy);
+
+        vector<float> scalarDots(count);
+        double scalarMs = timeMs(iterations, [&]() { for (size_t i = 0; i < count; ++i) scalarDots[i] = in.a[i].x * in.b[i].x + in.a[i].y * in.b[i].y; });
+        double batchMs = timeMs(iterations, [&]() { mapBatch<F>(a, b, out, op); });
+        passed &= report("dot", lanes, error, 1e-6f, scalarMs, batchMs);
+    }
+
+    // axpy: one step checked, then timed
+    {
+        const float scale = 0.5f;
+        for (size_t i = 0; i < count; ++i) expected[i] = in.b[i] + in.a[i] * scale;
+        Vector2Kernels::axpy<F>(scale, a, b);
+        float error = maxError(expected, bx, by);
+
+        vector<Vector2> scalarY = in.b;
+        double scalarMs = timeMs(iterations, [&]() { for (size_t i = 0; i < count; ++i) scalarY[i] = scalarY[i] + in.a[i] * scale; });
+        double batchMs = timeMs(iterations, [&]() { Vector2Kernels::axpy<F>(scale, a, b); });
+        passed &= report("axpy", lanes, error, 1e-6f, scalarMs, batchMs);
+    }
+
+    // rotate (kernel and Vector2xN::rotate)
+    {
+        const float angle = 0.3f;
+        const float c = cosf(angle), s = sinf(angle);
+        for (size_t i = 0; i < count; ++i) expected[i] = Vector2(in.a[i].x * c - in.a[i].y * s, in.a[i].x * s + in.a[i].y * c);
+        vector<float> rx = in.ax, ry = in.ay;
+        Vector2Span r = { rx.data(), ry.data(), count };
+        Vector2Kernels::rotate<F>(angle, r);
+        float error = maxError(expected, rx, ry);
+
+        vector<Vector2> scalarR = in.a;
+        double scalarMs = timeMs(iterations, [&]() { for (Vector2& v : scalarR) v = Vector2(v.x * c - v.y * s, v.x * s + v.y * c); });
+        double batchMs = timeMs(iterations, [&]() { Vector2Kernels::rotate<F>(angle, r); });
+        passed &= report("rotate", lanes, error, 1e-6f, scalarMs, batchMs);
+    }
+
+    // fastSin / fastCos against libm
+    {
+        vector<float> expectedSin(count), expectedCos(count), actual(count);
+        for (size_t i = 0; i < count; ++i) {
+            expectedSin[i] = sinf(in.theta[i]);
+            expectedCos[i] = cosf(in.theta[i]);
+        }
+
+        auto sinOp = [](auto angle) { return fastSin(angle); };
+        auto cosOp = [](auto angle) { return fastCos(angle); };
+        vector<float> scalar(count);
+
+        mapAngles<F>(in.theta, actual, sinOp);
+        float error = maxError(expectedSin, actual);
+        double scalarMs = timeMs(iterations, [&]() { for (size_t i = 0; i < count; ++i) scalar[i] = sinf(in.theta[i]); });
+        double batchMs = timeMs(iterations, [&]() { mapAngles<F>(in.theta, actual, sinOp); });
+        passed &= report("fastSin", lanes, error, 2e-3f, scalarMs, batchMs);
+
+        mapAngles<F>(in.theta, actual, cosOp);
+        error = maxError(expectedCos, actual);
+        scalarMs = timeMs(iterations, [&]() { for (size_t i = 0; i < count; ++i) scalar[i] = cosf(in.theta[i]); });
+        batchMs = timeMs(iterations, [&]() { mapAngles<F>(in.theta, actual, cosOp); });
+        passed &= report("fastCos", lanes, error, 2e-3f, scalarMs, batchMs);
+    }
+
+    // theta cone directions, fast approximation vs. libm
+    {
+        for (size_t i = 0; i < count; ++i) expected[i] = Vector2(cosf(in.theta[i]), sinf(in.theta[i])) * in.speed[i];
+        Vector2Kernels::directionsFromTheta<F>(in.theta.data(), in.speed.data(), out);
+        float error = maxError(expected, ox, oy);
+
+        double scalarMs = timeMs(iterations, [&]() {
+            for (size_t i = 0; i < count; ++i) scalarOut[i] = Vector2(cosf(in.theta[i]), sinf(in.theta[i])) * in.speed[i];
+        });
+        double batchMs = timeMs(iterations, [&]() { Vector2Kernels::directionsFromTheta<F>(in.theta.data(), in.speed.data(), out); });
+        passed &= report("directions", lanes, error, 2e-3f, scalarMs, batchMs);
+    }
+
+    return passed;
+}
+
+bool benchmarkBatchMath(size_t count, int iterations) {
+    BatchInputs in;
+    in.a.resize(count);
+    in.b.resize(count);
+    in.ax.resize(count); in.ay.resize(count);
+    in.bx.resize(count); in.by.resize(count);
+    in.theta.resize(count);
+    in.speed.resize(count);
+
+    for (size_t i = 0; i < count; ++i) {
+        in.a[i] = Vector2(randomFloat(-1.0f, 1.0f), randomFloat(-1.0f, 1.0f));
+        in.b[i] = Vector2(randomFloat(-1.0f, 1.0f), randomFloat(-1.0f, 1.0f));
+        in.ax[i] = in.a[i].x; in.ay[i] = in.a[i].y;
+        in.bx[i] = in.b[i].x; in.by[i] = in.b[i].y;
+        in.theta[i] = randomFloat(-10.0f, 10.0f);
+        in.speed[i] = randomFloat(0.5f, 1.0f);
+    }
+
+    cout << "Batch math benchmark (" << count << " vectors, " << iterations << " iterations)" << endl;
+    cout << "op          lanes      scalar(ms)   batch(ms)   speedup   max-error" << endl;
+
+    bool passed = checkLaneType<Floatx1>("x1", in, iterations);
+#if defined(VECTOR2_BATCH_SSE) || defined(VECTOR2_BATCH_NEON)
+    passed &= checkLaneType<Floatx4>("x4", in, iterations);
+#endif
+#if defined(VECTOR2_BATCH_AVX2)
+    passed &= checkLaneType<Floatx8>("x8", in, iterations);
+#endif
+
+    cout << (passed ? "All batch ops match Vector2." : "Batch ops FAILED against Vector2.") << endl;
+    return passed;
+}
@@ -0,0 +1,241 @@
+#ifndef VECTOR2BATCH_H
+#define VECTOR2BATCH_H
+
+#include <cstddef>
+#include <cmath>
+
+#if defined(__AVX2__)
+#define VECTOR2_BATCH_AVX2
+#include <immintrin.h>
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define VECTOR2_BATCH_SSE
+#include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define VECTOR2_BATCH_NEON
+#include <arm_neon.h>
+#endif
+
+// Lane types. Each wraps one SIMD register (or a single float) behind the same
+// interface so the array kernels below are written once.
+
+class Floatx1 {
+public:
+    static const size_t width = 1;
+    float v;
+
+    constexpr Floatx1() : v(0.0f) {}
+    constexpr Floatx1(float value) : v(value) {}
+
+    static Floatx1 load(const float* p) { return Floatx1(*p); }
+    void store(float* p) const { *p = v; }
+
+    constexpr Floatx1 operator+(Floatx1 other) const { return Floatx1(v + other.v); }
+    constexpr Floatx1 operator-(Floatx1 other) const { return Floatx1(v - other.v); }
+    constexpr Floatx1 operator*(Floatx1 other) const { return Floatx1(v * other.v); }
+
+    // Absolute value; fabsf clears the sign bit rather than branching
+    Floatx1 abs() const { return Floatx1(fabsf(v)); }
+    // Round to nearest integer
+    Floatx1 round() const { return Floatx1(nearbyintf(v)); }
+};
+
+#if defined(VECTOR2_BATCH_AVX2)
+class Floatx8 {
+public:
+    static const size_t width = 8;
+    __m256 v;
+
+    Floatx8() : v(_mm256_setzero_ps()) {}
+    Floatx8(__m256 value) : v(value) {}
+    Floatx8(float value) : v(_mm256_set1_ps(value)) {}
+
+    static Floatx8 load(const float* p) { return Floatx8(_mm256_loadu_ps(p)); }
+    void store(float* p) const { _mm256_storeu_ps(p, v); }
+
+    Floatx8 operator+(Floatx8 other) const { return Floatx8(_mm256_add_ps(v, other.v)); }
+    Floatx8 operator-(Floatx8 other) const { return Floatx8(_mm256_sub_ps(v, other.v)); }
+    Floatx8 operator*(Floatx8 other) const { return Floatx8(_mm256_mul_ps(v, other.v)); }
+
+    Floatx8 abs() const { return Floatx8(_mm256_andnot_ps(_mm256_set1_ps(-0.0f), v)); }
+    Floatx8 round() const { return Floatx8(_mm256_round_ps(v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC)); }
+};
+#endif
+
+#if defined(VECTOR2_BATCH_SSE)
+class Floatx4 {
+public:
+    static const size_t width = 4;
+    __m128 v;
+
+    Floatx4() : v(_mm_setzero_ps()) {}
+    Floatx4(__m128 value) : v(value) {}
+    Floatx4(float value) : v(_mm_set1_ps(value)) {}
+
+    static Floatx4 load(const float* p) { return Floatx4(_mm_loadu_ps(p)); }
+    void store(float* p) const { _mm_storeu_ps(p, v); }
+
+    Floatx4 operator+(Floatx4 other) const { return Floatx4(_mm_add_ps(v, other.v)); }
+    Floatx4 operator-(Floatx4 other) const { return Floatx4(_mm_sub_ps(v, other.v)); }
+    Floatx4 operator*(Floatx4 other) const { return Floatx4(_mm_mul_ps(v, other.v)); }
+
+    Floatx4 abs() const { return Floatx4(_mm_andnot_ps(_mm_set1_ps(-0.0f), v)); }
+    // SSE2 has no round instruction; the int conversion rounds to nearest
+    Floatx4 round() const { return Floatx4(_mm_cvtepi32_ps(_mm_cvtps_epi32(v))); }
+};
+#elif defined(VECTOR2_BATCH_NEON)
+class Floatx4 {
+public:
+    static const size_t width = 4;
+    float32x4_t v;
+
+    Floatx4() : v(vdupq_n_f32(0.0f)) {}
+    Floatx4(float32x4_t value) : v(value) {}
+    Floatx4(float value) : v(vdupq_n_f32(value)) {}
+
+    static Floatx4 load(const float* p) { return Floatx4(vld1q_f32(p)); }
+    void store(float* p) const { vst1q_f32(p, v); }
+
+    Floatx4 operator+(Floatx4 other) const { return Floatx4(vaddq_f32(v, other.v)); }
+    Floatx4 operator-(Floatx4 other) const { return Floatx4(vsubq_f32(v, other.v)); }
+    Floatx4 operator*(Floatx4 other) const { return Floatx4(vmulq_f32(v, other.v)); }
+
+    Floatx4 abs() const { return Floatx4(vabsq_f32(v)); }
+    Floatx4 round() const { return Floatx4(vrndnq_f32(v)); }
+};
+#endif
+
+// Widest lane type available for this build
+#if defined(VECTOR2_BATCH_AVX2)
+typedef Floatx8 FloatBatch;
+#elif defined(VECTOR2_BATCH_SSE) || defined(VECTOR2_BATCH_NEON)
+typedef Floatx4 FloatBatch;
+#else
+typedef Floatx1 FloatBatch;
+#endif
+
+// A batch of 2D vectors, one per lane. Unlike Vector2 there is no division
+// operator, so nothing here branches per element.
+template <typename F>
+class Vector2xN {
+public:
+    static const size_t width = F::width;
+    F x, y;
+
+    constexpr Vector2xN() : x(), y() {}
+    constexpr Vector2xN(F xVal, F yVal) : x(xVal), y(yVal) {}
+
+    static Vector2xN load(const float* xs, const float* ys) { return Vector2xN(F::load(xs), F::load(ys)); }
+    void store(float* xs, float* ys) const { x.store(xs); y.store(ys); }
+
+    constexpr Vector2xN operator+(const Vector2xN& other) const { return Vector2xN(x + other.x, y + other.y); }
+    constexpr Vector2xN operator-(const Vector2xN& other) const { return Vector2xN(x - other.x, y - other.y); }
+    constexpr Vector2xN operator*(F scalar) const { return Vector2xN(x * scalar, y * scalar); }
+
+    constexpr F dot(const Vector2xN& other) const { return x * other.x + y * other.y; }
+
+    // Rotates every lane by the angle whose cosine/sine are given
+    constexpr Vector2xN rotate(F cosAngle, F sinAngle) const {
+        return Vector2xN(x * cosAngle - y * sinAngle, x * sinAngle + y * cosAngle);
+    }
+};
+
+typedef Vector2xN<Floatx1> Vector2x1;
+#if defined(VECTOR2_BATCH_AVX2)
+typedef Vector2xN<Floatx8> Vector2x8;
+#endif
+#if defined(VECTOR2_BATCH_SSE) || defined(VECTOR2_BATCH_NEON)
+typedef Vector2xN<Floatx4> Vector2x4;
+#endif
+typedef Vector2xN<FloatBatch> Vector2Batch;
+
+// Structure-of-arrays view over `count` 2D vectors
+struct Vector2Span {
+    float* x;
+    float* y;
+    size_t count;
+};
+
+// Parabolic sine approximation, valid for any input after range reduction to
+// [-PI, PI]. Max absolute error is about 1e-3, plenty for particle directions.
+template <typename F>
+inline F fastSin(F angle) {
+    const F invTwoPi(0.15915494f);
+    const F twoPi(6.28318531f);
+    const F b(1.27323954f);   // 4 / PI
+    const F c(-0.40528473f);  // -4 / PI^2
+    const F p(0.225f);
+
+    angle = angle - twoPi * (angle * invTwoPi).round();
+    F y = b * angle + c * angle * angle.abs();
+    return p * (y * y.abs() - y) + y;
+}
+
+template <typename F>
+inline F fastCos(F angle) {
+    return fastSin(angle + F(1.57079633f));
+}
+
+namespace Vector2Kernels {
+
+    // y += a * x
+    template <typename F = FloatBatch>
+    void axpy(float a, const Vector2Span& x, const Vector2Span& y) {
+        typedef Vector2xN<F> V;
+        const F scale(a);
+        size_t i = 0;
+        for (; i + V::width <= y.count; i += V::width) {
+            (V::load(y.x + i, y.y + i) + V::load(x.x + i, x.y + i) * scale).store(y.x + i, y.y + i);
+        }
+        for (; i < y.count; ++i) {
+            y.x[i] += a * x.x[i];
+            y.y[i] += a * x.y[i];
+        }
+    }
+
+    // Rotates every vector in place by `angle` radians
+    template <typename F = FloatBatch>
+    void rotate(float angle, const Vector2Span& v) {
+        typedef Vector2xN<F> V;
+        const float c = cosf(angle);
+        const float s = sinf(angle);
+        const F cosAngle(c);
+        const F sinAngle(s);
+        size_t i = 0;
+        for (; i + V::width <= v.count; i += V::width) {
+            V::load(v.x + i, v.y + i).rotate(cosAngle, sinAngle).store(v.x + i, v.y + i);
+        }
+        for (; i < v.count; ++i) {
+            float x = v.x[i];
+            v.x[i] = x * c - v.y[i] * s;
+            v.y[i] = x * s + v.y[i] * c;
+        }
+    }
+
+    // out[i] = (cos(theta[i]), sin(theta[i])) * speed[i], the emission cone of
+    // the update shader. Uses fastSin/fastCos for every element, tail included.
+    template <typename F = FloatBatch>
+    void directionsFromTheta(const float* theta, const float* speed, const Vector2Span& out) {
+        size_t i = 0;
+        for (; i + F::width <= out.count; i += F::width) {
+            F angle = F::load(theta + i);
+            F s = F::load(speed + i);
+            (fastCos(angle) * s).store(out.x + i);
+            (fastSin(angle) * s).store(out.y + i);
+        }
+        for (; i < out.count; ++i) {
+            Floatx1 angle(theta[i]);
+            out.x[i] = fastCos(angle).v * speed[i];
+            out.y[i] = fastSin(angle).v * speed[i];
+        }
+    }
+
+}
+
+// Checks every batch op, for every lane type compiled in, against the scalar
+// Vector2 and times it against a plain scalar loop. Returns false if any op
+// falls outside its tolerance.
+bool benchmarkBatchMath(size_t count, int iterations);
+
+#endif // !VECTOR2BATCH_H
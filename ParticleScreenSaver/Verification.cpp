@@ -0,0 +1,134 @@
+#include "Verification.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+
+using namespace std;
+
+StateComparison compareParticleStates(const Particle* actual, const Particle* expected, size_t count, float tolerance) {
+    StateComparison result = { 0, 0.0f };
+
+    for (size_t i = 0; i < count; ++i) {
+        const float* a = reinterpret_cast<const float*>(&actual[i]);
+        const float* e = reinterpret_cast<const float*>(&expected[i]);
+
+        float error = 0.0f;
+        for (size_t j = 0; j < sizeof(Particle) / sizeof(float); ++j) {
+            error = max(error, fabsf(a[j] - e[j]));
+        }
+
+        if (error > tolerance) {
+            result.mismatches++;
+        }
+        result.maxError = max(result.maxError, error);
+    }
+
+    return result;
+}
+
+vector<uint8_t> rasterizeParticles(const Particle* particles, size_t count, int width, int height) {
+    vector<uint8_t> image(width * height, 0);
+
+    for (size_t i = 0; i < count; ++i) {
+        // NDC to window coordinates. A 1 pixel point covers the pixel whose
+        // centre is in [w - 0.5, w + 0.5), i.e. ceil(w) - 1: the same as floor
+        // except at exact pixel edges, which FeatureBounds clamps to.
+        int x = static_cast<int>(ceilf((particles[i].position[0] * 0.5f + 0.5f) * width)) - 1;
+        int y = static_cast<int>(ceilf((particles[i].position[1] * 0.5f + 0.5f) * height)) - 1;
+
+        if (x >= 0 && x < width && y >= 0 && y < height) {
+            image[y * width + x] = 255;
+        }
+    }
+
+    return image;
+}
+
+static vector<float> boxBlur(const vector<uint8_t>& image, int width, int height) {
+    vector<float> blurred(width * height);
+
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            float sum = 0.0f;
+            for (int dy = -1; dy <= 1; ++dy) {
+                for (int dx = -1; dx <= 1; ++dx) {
+                    int sx = min(max(x + dx, 0), width - 1);
+                    int sy = min(max(y + dy, 0), height - 1);
+                    sum += image[sy * width + sx];
+                }
+            }
+            blurred[y * width + x] = sum / (9.0f * 255.0f);
+        }
+    }
+
+    return blurred;
+}
+
+float compareImages(const vector<uint8_t>& actual, const vector<uint8_t>& expected, int width, int height) {
+    vector<float> a = boxBlur(actual, width, height);
+    vector<float> e = boxBlur(expected, width, height);
+
+    double sum = 0.0;
+    for (size_t i = 0; i < a.size(); ++i) {
+        sum += fabsf(a[i] - e[i]);
+    }
+
+    return static_cast<float>(sum / a.size());
+}
+
+static const char ParticleStateMagic[4] = { 'P', 'S', 'S', '1' };
+
+bool writeParticleState(const string& path, const vector<Particle>& particles) {
+    ofstream file(path, ios::binary);
+    uint32_t count = static_cast<uint32_t>(particles.size());
+
+    file.write(ParticleStateMagic, sizeof(ParticleStateMagic));
+    file.write(reinterpret_cast<const char*>(&count), sizeof(count));
+    file.write(reinterpret_cast<const char*>(particles.data()), particles.size() * sizeof(Particle));
+    return file.good();
+}
+
+bool readParticleState(const string& path, vector<Particle>& particles) {
+    ifstream file(path, ios::binary);
+    char magic[sizeof(ParticleStateMagic)];
+    uint32_t count = 0;
+
+    file.read(magic, sizeof(magic));
+    file.read(reinterpret_cast<char*>(&count), sizeof(count));
+    if (!file || memcmp(magic, ParticleStateMagic, sizeof(magic)) != 0) {
+        return false;
+    }
+
+    particles.resize(count);
+    file.read(reinterpret_cast<char*>(particles.data()), count * sizeof(Particle));
+    return file.good();
+}
+
+bool writeImage(const string& path, const vector<uint8_t>& image, int width, int height) {
+    ofstream file(path, ios::binary);
+    file << "P5\n" << width << " " << height << "\n255\n";
+    for (int y = height - 1; y >= 0; --y) {
+        file.write(reinterpret_cast<const char*>(&image[y * width]), width);
+    }
+    return file.good();
+}
+
+bool readImage(const string& path, vector<uint8_t>& image, int width, int height) {
+    ifstream file(path, ios::binary);
+    string format;
+    int fileWidth = 0, fileHeight = 0, maxValue = 0;
+
+    file >> format >> fileWidth >> fileHeight >> maxValue;
+    file.get(); // single whitespace before the pixels
+    if (!file || format != "P5" || fileWidth != width || fileHeight != height || maxValue != 255) {
+        return false;
+    }
+
+    image.resize(width * height);
+    for (int y = height - 1; y >= 0; --y) {
+        file.read(reinterpret_cast<char*>(&image[y * width]), width);
+    }
+    return file.good();
+}
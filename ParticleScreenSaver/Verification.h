@@ -0,0 +1,35 @@
+#ifndef VERIFICATION_H
+#define VERIFICATION_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Particle.h"
+
+// CPU side of Application::verify: compares the GPU's particle state and
+// rendered frame against the reference kernel's, and reads/writes goldens.
+
+struct StateComparison {
+	size_t mismatches; // particles with any field off by more than the tolerance
+	float maxError;
+};
+
+StateComparison compareParticleStates(const Particle* actual, const Particle* expected, size_t count, float tolerance);
+
+// 8-bit luminance image of 1 pixel points, bottom row first like glReadPixels
+std::vector<uint8_t> rasterizeParticles(const Particle* particles, size_t count, int width, int height);
+
+// Mean absolute difference of the two images after a 3x3 box blur, 0..1.
+// The blur forgives points landing one pixel over (rounding at pixel edges)
+// while missing, extra or misplaced points still add up.
+float compareImages(const std::vector<uint8_t>& actual, const std::vector<uint8_t>& expected, int width, int height);
+
+// Goldens. The state is the raw Particle array behind a small header; the
+// image is a binary PGM, top row first so it opens upright in a viewer.
+bool writeParticleState(const std::string& path, const std::vector<Particle>& particles);
+bool readParticleState(const std::string& path, std::vector<Particle>& particles);
+bool writeImage(const std::string& path, const std::vector<uint8_t>& image, int width, int height);
+bool readImage(const std::string& path, std::vector<uint8_t>& image, int width, int height);
+
+#endif // !VERIFICATION_H
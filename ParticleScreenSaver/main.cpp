@@ -1,7 +1,99 @@
+#include <cstdlib>
+#include <cstring>
 #include "Application.h"
+#include "ParticleKernel.h"
+#include "Vector2Batch.h"
+
+int main(int argc, char** argv) {
+    if (argc > 1 && strcmp(argv[1], "--benchmark-kernels") == 0) {
+        benchmarkUpdateKernels(1000000, 100);
+        return 0;
+    }
+
+    if (argc > 1 && strcmp(argv[1], "--benchmark-shaders") == 0) {
+        Application benchmark("Particle Benchmark", 1000000, 1.01f, 1.15f, IntVector2(800, 800), true);
+        benchmark.benchmarkUpdateShaders(100);
+        return 0;
+    }
+
+    // --benchmark-batch [count] [iterations]; fails if any op is out of tolerance
+    if (argc > 1 && strcmp(argv[1], "--benchmark-batch") == 0) {
+        size_t count = argc > 2 ? strtoul(argv[2], nullptr, 10) : 1000000;
+        int iterations = argc > 3 ? atoi(argv[3]) : 100;
+        return benchmarkBatchMath(count, iterations) ? 0 : 1;
+    }
+
+    // --verify [steps] [--goldens <dir>] [--update-goldens] [--features <hex mask>|runtime|trails]...
+    // Without --features every update path and the trails are checked.
+    if (argc > 1 && strcmp(argv[1], "--verify") == 0) {
+        int steps = 120;
+        const char* goldenDirectory = "goldens";
+        bool updateGoldens = false;
+        std::vector<unsigned> programs;
+        bool trails = false;
+        bool allPaths = true;
+
+        for (int i = 2; i < argc; ++i) {
+            if (strcmp(argv[i], "--update-goldens") == 0) {
+                updateGoldens = true;
+            }
+            else if (strcmp(argv[i], "--features") == 0 && i + 1 < argc) {
+                const char* features = argv[++i];
+                allPaths = false;
+                if (strcmp(features, "trails") == 0) {
+                    trails = true;
+                }
+                else {
+                    programs.push_back(strcmp(features, "runtime") == 0
+                        ? Application::RuntimeFeatureProgram
+                        : static_cast<unsigned>(strtoul(features, nullptr, 16)));
+                }
+            }
+            else if (strcmp(argv[i], "--goldens") == 0 && i + 1 < argc) {
+                goldenDirectory = argv[++i];
+            }
+            else {
+                steps = atoi(argv[i]);
+            }
+        }
+
+        if (allPaths) {
+            programs = Application::verifyUpdatePaths();
+            trails = true;
+        }
+
+        Application verification("Particle Verification", 16384, 1.01f, 1.15f, IntVector2(256, 256), true, trails);
+        // Fast enough to reach the screen edges, so FeatureBounds has something to do
+        verification.speed[0] = 1.0f;
+        verification.speed[1] = 3.0f;
+        return verification.verify(steps, 1.0f / 60.0f, 1234, goldenDirectory, updateGoldens, programs) ? 0 : 1;
+    }
+
+    bool trails = false;
+    double targetFrameRate = 30.0;
+    const char* statsExportPath = nullptr;
+
+    // Options can come in any order: [--trails] [--stats-csv <path>] [--fps <n>]
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--trails") == 0) {
+            trails = true;
+        }
+        else if (strcmp(argv[i], "--fps") == 0 && i + 1 < argc) {
+            // 0 restores the uncapped, vsync-limited loop
+            targetFrameRate = atof(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--stats-csv") == 0 && i + 1 < argc) {
+            statsExportPath = argv[++i];
+        }
+        else {
+            cerr << "Ignoring unknown argument: " << argv[i] << endl;
+        }
+    }
+
+    Application application("Particle Simulation", 1000000, 1.01f, 1.15f, IntVector2(800, 800), false, trails);
+    application.targetFrameRate = targetFrameRate;
+    application.statsExportPath = statsExportPath;
 
-int main(void) {
-    Application application("Particle Simulation", 1000000, 1.01f, 1.15f, IntVector2(800, 800));
     application.run();
 
     return 0;